@@ -0,0 +1,37 @@
+#ifndef TETRIS_BENCH_ALLOCATION_COUNTER_H
+#define TETRIS_BENCH_ALLOCATION_COUNTER_H
+
+#include <atomic>
+#include <cstdint>
+#include <benchmark/benchmark.h>
+
+/**
+ * @brief Number of calls to global operator new since the program started
+ *
+ */
+extern std::atomic<uint64_t> allocation_count;
+
+/**
+ * @brief Counts heap allocations over the timed loop of a benchmark and reports them as allocs/op
+ *
+ */
+class AllocationReporter
+{
+    benchmark::State &state;
+    uint64_t start;
+
+public:
+    explicit AllocationReporter(benchmark::State &state)
+        : state(state), start(allocation_count.load(std::memory_order_relaxed))
+    {
+    }
+
+    ~AllocationReporter()
+    {
+        double allocations = static_cast<double>(allocation_count.load(std::memory_order_relaxed) - start);
+        state.counters["allocs/op"] = benchmark::Counter(allocations, benchmark::Counter::kAvgIterations);
+        state.SetItemsProcessed(state.iterations());
+    }
+};
+
+#endif // TETRIS_BENCH_ALLOCATION_COUNTER_H
@@ -0,0 +1,369 @@
+#include <array>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "tetris/arena.h"
+#include "tetris/beam_search.h"
+#include "tetris/board.h"
+#include "tetris/candidate_pipeline.h"
+#include "tetris/evaluation.h"
+#include "tetris/placement.h"
+#include "tetris/reachability.h"
+#include "tetris/search.h"
+#include "allocation_counter.h"
+#include <benchmark/benchmark.h>
+
+namespace
+{
+    struct Drop
+    {
+        TetrisPiece piece;
+        int col_offset;
+    };
+
+    // A fixed, seeded sequence of drops covering every standard piece and orientation
+    const std::vector<Drop> &benchDrops()
+    {
+        static const std::vector<Drop> drops = []
+        {
+            std::mt19937 rng(2024);
+            std::vector<TetrisPiece> pieces;
+            for (const auto &[name, factory] : TetrisPiece::pieceFactories)
+            {
+                pieces.push_back(factory());
+            }
+            std::vector<Drop> result;
+            for (int drop = 0; drop < 4096; drop++)
+            {
+                TetrisPiece piece = pieces[rng() % pieces.size()];
+                piece.setOrientation(rng() % kOrientationCount);
+                result.push_back(Drop{piece, static_cast<int>(rng() % (TetrisBoard::width - piece.width + 1))});
+            }
+            return result;
+        }();
+        return drops;
+    }
+
+    // A half-filled board built from the bench drops
+    TetrisBoard benchBoard()
+    {
+        TetrisBoard board;
+        for (const Drop &drop : benchDrops())
+        {
+            if (board.maxHeight() >= TetrisBoard::height / 2)
+            {
+                break;
+            }
+            board.addPiece(drop.piece, drop.col_offset);
+        }
+        return board;
+    }
+}
+
+static void BM_BoardAddPiece(benchmark::State &state)
+{
+    const std::vector<Drop> &drops = benchDrops();
+    TetrisBoard board;
+    size_t idx = 0;
+    AllocationReporter allocations(state);
+    for (auto _ : state)
+    {
+        const Drop &drop = drops[idx];
+        if (board.landingRow(drop.piece, drop.col_offset) + drop.piece.height > TetrisBoard::height)
+        {
+            board = TetrisBoard{};
+        }
+        int cleared = board.addPiece(drop.piece, drop.col_offset);
+        benchmark::DoNotOptimize(cleared);
+        idx = (idx + 1) % drops.size();
+    }
+}
+BENCHMARK(BM_BoardAddPiece);
+
+// Try each drop on a half-filled board and restore it, either by copying the board first (arg 0) or with make and unmake (arg 1)
+static void BM_BoardTryMove(benchmark::State &state)
+{
+    const std::vector<Drop> &drops = benchDrops();
+    TetrisBoard board = benchBoard();
+    bool make_unmake = state.range(0) != 0;
+    size_t idx = 0;
+    AllocationReporter allocations(state);
+    for (auto _ : state)
+    {
+        const Drop &drop = drops[idx];
+        idx = (idx + 1) % drops.size();
+        if (board.landingRow(drop.piece, drop.col_offset) + drop.piece.height > TetrisBoard::height)
+        {
+            continue;
+        }
+        if (make_unmake)
+        {
+            TetrisBoard::UndoRecord undo;
+            int cleared = board.makeMove(drop.piece, drop.col_offset, undo);
+            benchmark::DoNotOptimize(cleared);
+            benchmark::DoNotOptimize(board);
+            board.unmakeMove(undo);
+        }
+        else
+        {
+            TetrisBoard child = board;
+            int cleared = child.addPiece(drop.piece, drop.col_offset);
+            benchmark::DoNotOptimize(cleared);
+            benchmark::DoNotOptimize(child);
+        }
+    }
+}
+BENCHMARK(BM_BoardTryMove)->ArgName("make_unmake")->Arg(0)->Arg(1);
+
+static void BM_BoardLineClear(benchmark::State &state)
+{
+    // Fill nine columns four rows high, then finish the rows with a vertical I piece
+    TetrisBoard base;
+    TetrisPiece q_piece = TetrisPiece::createQPiece();
+    for (int col_idx = 0; col_idx < 8; col_idx += 2)
+    {
+        base.addPiece(q_piece, col_idx);
+        base.addPiece(q_piece, col_idx);
+    }
+    base.addPiece(TetrisPiece{{{true, true, true, true}}}, 8);
+    TetrisPiece i_piece = TetrisPiece::createIPiece();
+    i_piece.rotateClockwise();
+    AllocationReporter allocations(state);
+    for (auto _ : state)
+    {
+        TetrisBoard board = base;
+        int cleared = board.addPiece(i_piece, 9);
+        benchmark::DoNotOptimize(cleared);
+        benchmark::DoNotOptimize(board);
+    }
+}
+BENCHMARK(BM_BoardLineClear);
+
+// Push a batch of garbage into a half-filled board, then clear four full rows at once, as a versus move does to both boards
+static void BM_BoardGarbageExchange(benchmark::State &state)
+{
+    TetrisBoard base = benchBoard();
+    TetrisBoard::Row full = TetrisBoard::kFullRow;
+    std::array<TetrisBoard::Row, TetrisBoard::height> stacked{};
+    for (int row_idx = 0; row_idx < TetrisBoard::height / 2; row_idx++)
+    {
+        stacked[row_idx] = row_idx % 3 == 0 ? full : base.row(row_idx);
+    }
+    TetrisBoard with_full_rows{std::span<const TetrisBoard::Row>(stacked)};
+    TetrisBoard::RowMask full_rows = with_full_rows.fullRows();
+    int hole_column = 0;
+    AllocationReporter allocations(state);
+    for (auto _ : state)
+    {
+        TetrisBoard board = base;
+        board.insertGarbage(4, hole_column);
+        TetrisBoard clearing = with_full_rows;
+        int cleared = clearing.clearRows(full_rows);
+        benchmark::DoNotOptimize(board);
+        benchmark::DoNotOptimize(cleared);
+        hole_column = (hole_column + 1) % TetrisBoard::width;
+    }
+}
+BENCHMARK(BM_BoardGarbageExchange);
+
+static void BM_BoardLandingRow(benchmark::State &state)
+{
+    const std::vector<Drop> &drops = benchDrops();
+    TetrisBoard board = benchBoard();
+    size_t idx = 0;
+    AllocationReporter allocations(state);
+    for (auto _ : state)
+    {
+        int row = board.landingRow(drops[idx].piece, drops[idx].col_offset);
+        benchmark::DoNotOptimize(row);
+        idx = (idx + 1) % drops.size();
+    }
+}
+BENCHMARK(BM_BoardLandingRow);
+
+static void BM_BoardCollides(benchmark::State &state)
+{
+    const std::vector<Drop> &drops = benchDrops();
+    TetrisBoard board = benchBoard();
+    size_t idx = 0;
+    AllocationReporter allocations(state);
+    for (auto _ : state)
+    {
+        bool hit = board.collides(drops[idx].piece, drops[idx].col_offset, static_cast<int>(idx % TetrisBoard::height));
+        benchmark::DoNotOptimize(hit);
+        idx = (idx + 1) % drops.size();
+    }
+}
+BENCHMARK(BM_BoardCollides);
+
+static void BM_BoardMetrics(benchmark::State &state)
+{
+    TetrisBoard board = benchBoard();
+    int col_idx = 0;
+    AllocationReporter allocations(state);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(board);
+        int sum = board.maxHeight() + board.highestBlockInColumn(col_idx) + board.holes();
+        benchmark::DoNotOptimize(sum);
+        col_idx = col_idx + 1 == TetrisBoard::width ? 0 : col_idx + 1;
+    }
+}
+BENCHMARK(BM_BoardMetrics);
+
+static void BM_EnumeratePlacements(benchmark::State &state)
+{
+    TetrisBoard board = benchBoard();
+    TetrisPiece piece = TetrisPiece::createLPiece();
+    std::array<Placement, kMaxPlacements> placements;
+    AllocationReporter allocations(state);
+    for (auto _ : state)
+    {
+        size_t count = enumeratePlacements(board, piece, placements);
+        benchmark::DoNotOptimize(count);
+        benchmark::DoNotOptimize(placements);
+    }
+}
+BENCHMARK(BM_EnumeratePlacements);
+
+static void BM_ReachablePlacements(benchmark::State &state)
+{
+    TetrisBoard board = benchBoard();
+    TetrisPiece piece = TetrisPiece::createTPiece();
+    auto search = std::make_unique<ReachabilitySearch>();
+    std::vector<ReachablePlacement> placements(ReachabilitySearch::kMaxReachable);
+    AllocationReporter allocations(state);
+    for (auto _ : state)
+    {
+        size_t count = search->search(board, piece, placements);
+        benchmark::DoNotOptimize(count);
+        benchmark::DoNotOptimize(placements.data());
+    }
+}
+BENCHMARK(BM_ReachablePlacements);
+
+static void BM_CandidatePipeline(benchmark::State &state)
+{
+    // The full evaluation is a one piece lookahead, the kind of expensive stage pruning is meant to protect
+    FeatureWeights weights{-0.51f, -0.18f, -0.36f, 0.76f, -0.05f};
+    PipelineOptions lookahead_options;
+    lookahead_options.prune = false;
+    CandidatePipeline lookahead(weights, [weights](const TetrisBoard &board, int lines_cleared)
+                                { return static_cast<double>(scoreFeatures(computeFeatures(board, lines_cleared), weights)); },
+                                lookahead_options);
+    TetrisPiece next = TetrisPiece::createLPiece();
+    EvaluationFunction evaluate = [&lookahead, next](const TetrisBoard &board, int)
+    {
+        std::optional<ScoredCandidate> best = lookahead.best(board, next);
+        return best ? best->score : -std::numeric_limits<double>::infinity();
+    };
+
+    PipelineOptions options;
+    options.prune = state.range(0) > 0;
+    options.keep = static_cast<size_t>(state.range(0));
+    CandidatePipeline pipeline(weights, evaluate, options);
+    TetrisBoard board = benchBoard();
+    TetrisPiece piece = TetrisPiece::createTPiece();
+    AllocationReporter allocations(state);
+    for (auto _ : state)
+    {
+        std::optional<ScoredCandidate> best = pipeline.best(board, piece);
+        benchmark::DoNotOptimize(best);
+    }
+    state.counters["evaluated/move"] = static_cast<double>(pipeline.counters().evaluated) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_CandidatePipeline)->ArgName("keep")->Arg(0)->Arg(8)->Arg(4);
+
+static void BM_EvaluateBatch(benchmark::State &state)
+{
+    BoardBatch batch;
+    TetrisBoard board = benchBoard();
+    for (size_t lane = 0; lane < kBatchSize; lane++)
+    {
+        batch.set(lane, board, static_cast<int>(lane));
+    }
+    FeatureWeights weights{-0.51f, -0.18f, -0.36f, 0.76f, -0.05f};
+    FeatureBatch features;
+    AllocationReporter allocations(state);
+    for (auto _ : state)
+    {
+        evaluateBatch(batch, weights, features);
+        benchmark::DoNotOptimize(features);
+    }
+    state.counters["boards/s"] = benchmark::Counter(static_cast<double>(state.iterations() * kBatchSize), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_EvaluateBatch);
+
+static void BM_SearchTwoPly(benchmark::State &state)
+{
+    ThreadPool pool(static_cast<size_t>(state.range(0)));
+    GameTreeSearch search([](const TetrisBoard &board, int lines_cleared)
+                          { return lines_cleared - 0.5 * board.maxHeight() - board.holes(); },
+                          pool);
+    TetrisBoard board = benchBoard();
+    std::vector<TetrisPiece> pieces = {TetrisPiece::createTPiece(), TetrisPiece::createLPiece()};
+    AllocationReporter allocations(state);
+    for (auto _ : state)
+    {
+        SearchResult result = search.search(board, pieces);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_SearchTwoPly)->ArgName("threads")->Arg(1)->Arg(4)->UseRealTime();
+
+static void BM_BeamSearchTenPieces(benchmark::State &state)
+{
+    ThreadPool pool(static_cast<size_t>(state.range(0)));
+    BeamSearch search([](const TetrisBoard &board, int lines_cleared)
+                      { return lines_cleared - 0.5 * board.maxHeight() - board.holes(); },
+                      pool);
+    TetrisBoard board = benchBoard();
+    std::vector<TetrisPiece> pieces;
+    for (const Drop &drop : benchDrops())
+    {
+        if (pieces.size() == 10)
+        {
+            break;
+        }
+        pieces.push_back(drop.piece);
+    }
+    AllocationReporter allocations(state);
+    for (auto _ : state)
+    {
+        SearchResult result = search.search(board, pieces);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_BeamSearchTenPieces)->ArgName("threads")->Arg(1)->Arg(4)->UseRealTime();
+
+// Copies of a board made and discarded per node, on the heap and in an arena rewound after each batch
+static void BM_BoardCopies(benchmark::State &state)
+{
+    constexpr int kCopiesPerNode = 34;
+    TetrisBoard board = benchBoard();
+    bool use_arena = state.range(0) != 0;
+    Arena arena;
+    AllocationReporter allocations(state);
+    for (auto _ : state)
+    {
+        if (use_arena)
+        {
+            ArenaScope scope(arena);
+            for (int copy_idx = 0; copy_idx < kCopiesPerNode; copy_idx++)
+            {
+                benchmark::DoNotOptimize(arena.create<TetrisBoard>(board));
+            }
+        }
+        else
+        {
+            for (int copy_idx = 0; copy_idx < kCopiesPerNode; copy_idx++)
+            {
+                auto copy = std::make_unique<TetrisBoard>(board);
+                benchmark::DoNotOptimize(copy.get());
+            }
+        }
+    }
+}
+BENCHMARK(BM_BoardCopies)->ArgName("arena")->Arg(0)->Arg(1);
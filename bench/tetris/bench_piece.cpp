@@ -0,0 +1,138 @@
+#include <vector>
+
+#include "tetris/piece.h"
+#include "tetris/test_pieces.cpp"
+#include "allocation_counter.h"
+#include <benchmark/benchmark.h>
+
+// Shapes from the transformation tests, so runs use the same inputs across machines
+static const Shape &benchShape()
+{
+    return shape_5x6[0];
+}
+
+static void BM_PieceConstructFromShape(benchmark::State &state)
+{
+    const Shape &shape = benchShape();
+    AllocationReporter allocations(state);
+    for (auto _ : state)
+    {
+        TetrisPiece piece{shape};
+        benchmark::DoNotOptimize(piece);
+    }
+}
+BENCHMARK(BM_PieceConstructFromShape);
+
+static void BM_PieceFactory(benchmark::State &state)
+{
+    AllocationReporter allocations(state);
+    for (auto _ : state)
+    {
+        TetrisPiece piece = TetrisPiece::createLPiece();
+        benchmark::DoNotOptimize(piece);
+    }
+}
+BENCHMARK(BM_PieceFactory);
+
+static void BM_PieceFactoryMap(benchmark::State &state)
+{
+    AllocationReporter allocations(state);
+    for (auto _ : state)
+    {
+        TetrisPiece piece = TetrisPiece::pieceFactories.at('T')();
+        benchmark::DoNotOptimize(piece);
+    }
+}
+BENCHMARK(BM_PieceFactoryMap);
+
+static void BM_PieceCopy(benchmark::State &state)
+{
+    TetrisPiece source = TetrisPiece::createTPiece();
+    AllocationReporter allocations(state);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(source);
+        TetrisPiece copy = source;
+        benchmark::DoNotOptimize(copy);
+    }
+}
+BENCHMARK(BM_PieceCopy);
+
+// Apply one transformation per iteration to either a table-backed standard piece (arg 0) or the bitwise path on a 5x6 test shape (arg 1)
+template <void (TetrisPiece::*Transformation)()>
+static void BM_PieceTransform(benchmark::State &state)
+{
+    TetrisPiece piece = state.range(0) == 0 ? TetrisPiece::createLPiece() : TetrisPiece{benchShape()};
+    AllocationReporter allocations(state);
+    for (auto _ : state)
+    {
+        (piece.*Transformation)();
+        benchmark::DoNotOptimize(piece);
+    }
+}
+BENCHMARK_TEMPLATE(BM_PieceTransform, &TetrisPiece::rotateClockwise)->ArgName("bitwise")->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_PieceTransform, &TetrisPiece::rotateCounterClockwise)->ArgName("bitwise")->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_PieceTransform, &TetrisPiece::rotate180)->ArgName("bitwise")->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_PieceTransform, &TetrisPiece::flipHorizontal)->ArgName("bitwise")->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_PieceTransform, &TetrisPiece::flipVertical)->ArgName("bitwise")->Arg(0)->Arg(1);
+
+static void BM_PieceEquality(benchmark::State &state)
+{
+    std::vector<TetrisPiece> pieces;
+    for (const Shape &shape : shape_5x6)
+    {
+        pieces.emplace_back(shape);
+    }
+    size_t idx = 0;
+    AllocationReporter allocations(state);
+    for (auto _ : state)
+    {
+        bool equal = pieces[idx] == pieces[(idx + 3) % pieces.size()];
+        benchmark::DoNotOptimize(equal);
+        idx = (idx + 1) % pieces.size();
+    }
+}
+BENCHMARK(BM_PieceEquality);
+
+// Hash under rotations and reflections, either a table-backed standard piece (arg 0) or the bitwise path on the 5x6 test shapes (arg 1)
+static void BM_PieceCanonicalHash(benchmark::State &state)
+{
+    std::vector<TetrisPiece> pieces;
+    if (state.range(0) == 0)
+    {
+        for (const auto &[name, factory] : TetrisPiece::pieceFactories)
+        {
+            pieces.push_back(factory());
+        }
+    }
+    else
+    {
+        for (const Shape &shape : shape_5x6)
+        {
+            pieces.emplace_back(shape);
+        }
+    }
+    size_t idx = 0;
+    AllocationReporter allocations(state);
+    for (auto _ : state)
+    {
+        uint64_t hash = pieces[idx].canonicalHash(PieceSymmetry::RotationsAndReflections);
+        benchmark::DoNotOptimize(hash);
+        idx = (idx + 1) % pieces.size();
+    }
+}
+BENCHMARK(BM_PieceCanonicalHash)->ArgName("bitwise")->Arg(0)->Arg(1);
+
+static void BM_PieceLowestBlockInColumn(benchmark::State &state)
+{
+    TetrisPiece piece{benchShape()};
+    size_t col_idx = 0;
+    AllocationReporter allocations(state);
+    for (auto _ : state)
+    {
+        size_t lowest = piece.lowestBlockInColumn(col_idx);
+        benchmark::DoNotOptimize(lowest);
+        col_idx = col_idx + 1 == piece.width ? 0 : col_idx + 1;
+    }
+}
+BENCHMARK(BM_PieceLowestBlockInColumn);
@@ -0,0 +1,332 @@
+#ifndef TETRIS_ARENA_H
+#define TETRIS_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Counters describing how an arena or pool has been used
+ *
+ */
+struct AllocationStats
+{
+    // Objects handed out since the allocator was created
+    uint64_t allocations;
+    // Bytes of objects currently handed out
+    uint64_t bytes_in_use;
+    // Largest value bytes_in_use has reached
+    uint64_t peak_bytes;
+    // Number of blocks requested from the system allocator
+    uint64_t system_allocations;
+    // Total bytes requested from the system allocator
+    uint64_t reserved_bytes;
+};
+
+/**
+ * @brief Memory requested from the system allocator by every arena and pool in the process
+ *
+ */
+struct ReservedMemory
+{
+    uint64_t system_allocations;
+    uint64_t bytes;
+};
+
+/**
+ * @brief Get the memory requested from the system by every arena and pool so far. Safe to call from any thread.
+ *
+ * @return The totals since the program started
+ */
+ReservedMemory reservedMemory();
+
+/**
+ * @brief Add to the process wide totals returned by reservedMemory. Called by arenas and pools whenever they grow.
+ *
+ * @param bytes Size of the block requested from the system
+ */
+void countReservedMemory(size_t bytes);
+
+/**
+ * @brief Bump pointer allocator for short lived objects. Allocation is a pointer increment; nothing is freed individually. Instead the
+ * arena is rewound to an earlier mark, releasing everything allocated since in O(1). Blocks are kept when rewound, so an arena that has
+ * reached its working size no longer touches the system allocator. Not thread safe: use one arena per thread.
+ *
+ */
+class Arena
+{
+    struct Block
+    {
+        std::unique_ptr<std::byte[]> memory;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    // Block currently being carved up, and the offset of its first free byte
+    size_t block_idx;
+    size_t offset;
+    size_t block_size;
+    AllocationStats statistics;
+
+    // Move on to the next block with room for the allocation, requesting a new one from the system if there is none
+    void *allocateSlow(size_t size, size_t alignment);
+
+public:
+    /**
+     * @brief A position in the arena to rewind to
+     *
+     */
+    struct Marker
+    {
+        size_t block_idx;
+        size_t offset;
+        uint64_t bytes_in_use;
+    };
+
+    /**
+     * @brief Create an empty arena. No memory is requested until the first allocation.
+     *
+     * @param block_size Size of each block requested from the system. Larger allocations get a block of their own.
+     *
+     * @throws std::invalid_argument if block_size is zero
+     */
+    explicit Arena(size_t block_size = 64 * 1024);
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    /**
+     * @brief Allocate uninitialised memory
+     *
+     * @param size Number of bytes
+     * @param alignment Required alignment, which must be a power of two
+     * @return The memory, valid until the arena is rewound past this allocation
+     */
+    void *allocate(size_t size, size_t alignment)
+    {
+        statistics.allocations++;
+        statistics.bytes_in_use += size;
+        if (statistics.bytes_in_use > statistics.peak_bytes)
+        {
+            statistics.peak_bytes = statistics.bytes_in_use;
+        }
+
+        if (block_idx < blocks.size())
+        {
+            uintptr_t base = reinterpret_cast<uintptr_t>(blocks[block_idx].memory.get());
+            uintptr_t aligned = (base + offset + alignment - 1) & ~(uintptr_t{alignment} - 1);
+            if (aligned + size <= base + blocks[block_idx].size)
+            {
+                offset = aligned + size - base;
+                return reinterpret_cast<void *>(aligned);
+            }
+        }
+        return allocateSlow(size, alignment);
+    }
+
+    /**
+     * @brief Construct an object in the arena. Its destructor is never run, so only trivially destructible types are allowed.
+     *
+     * @param args Constructor arguments
+     * @return The new object
+     */
+    template <typename T, typename... Args>
+    T *create(Args &&...args)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "Arena objects are never destroyed");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Default construct an array of objects in the arena. Only trivially destructible types are allowed.
+     *
+     * @param count Number of objects
+     * @return The first object
+     */
+    template <typename T>
+    T *createArray(size_t count)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "Arena objects are never destroyed");
+        T *objects = static_cast<T *>(allocate(sizeof(T) * count, alignof(T)));
+        for (size_t object_idx = 0; object_idx < count; object_idx++)
+        {
+            new (objects + object_idx) T;
+        }
+        return objects;
+    }
+
+    /**
+     * @brief Get the current position of the arena
+     *
+     * @return A marker which rewind accepts
+     */
+    Marker mark() const
+    {
+        return Marker{block_idx, offset, statistics.bytes_in_use};
+    }
+
+    /**
+     * @brief Release everything allocated since the marker was taken. The memory is kept for reuse.
+     *
+     * @param marker A marker taken from this arena, with no rewind to an earlier marker since
+     */
+    void rewind(const Marker &marker)
+    {
+        block_idx = marker.block_idx;
+        offset = marker.offset;
+        statistics.bytes_in_use = marker.bytes_in_use;
+    }
+
+    /**
+     * @brief Release everything allocated from the arena. The memory is kept for reuse.
+     *
+     */
+    void reset()
+    {
+        rewind(Marker{0, 0, 0});
+    }
+
+    /**
+     * @brief Get the usage counters of the arena
+     *
+     * @return The counters
+     */
+    const AllocationStats &stats() const
+    {
+        return statistics;
+    }
+};
+
+/**
+ * @brief Rewinds an arena to where it was when the scope was entered
+ *
+ */
+class ArenaScope
+{
+    Arena &arena;
+    Arena::Marker marker;
+
+public:
+    explicit ArenaScope(Arena &arena)
+        : arena(arena), marker(arena.mark())
+    {
+    }
+
+    ~ArenaScope()
+    {
+        arena.rewind(marker);
+    }
+
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
+};
+
+/**
+ * @brief Free list allocator for long lived objects of a single type, such as boards kept across moves. Slots are carved from chunks
+ * that are only returned to the system when the pool is destroyed, so acquire and release are a few pointer operations. Not thread safe.
+ *
+ */
+template <typename T>
+class ObjectPool
+{
+    union Slot
+    {
+        Slot *next;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> chunks;
+    Slot *free_list;
+    size_t chunk_size;
+    AllocationStats statistics;
+
+    void grow()
+    {
+        chunks.push_back(std::make_unique<Slot[]>(chunk_size));
+        Slot *chunk = chunks.back().get();
+        for (size_t slot_idx = chunk_size; slot_idx-- > 0;)
+        {
+            chunk[slot_idx].next = free_list;
+            free_list = &chunk[slot_idx];
+        }
+        statistics.system_allocations++;
+        statistics.reserved_bytes += sizeof(Slot) * chunk_size;
+        countReservedMemory(sizeof(Slot) * chunk_size);
+    }
+
+public:
+    /**
+     * @brief Create an empty pool. No memory is requested until the first object is acquired.
+     *
+     * @param chunk_size Number of objects in each chunk requested from the system
+     *
+     * @throws std::invalid_argument if chunk_size is zero
+     */
+    explicit ObjectPool(size_t chunk_size = 256)
+        : free_list(nullptr), chunk_size(chunk_size), statistics{}
+    {
+        if (chunk_size == 0)
+        {
+            throw std::invalid_argument("Pool chunk size must be greater than zero");
+        }
+    }
+
+    ObjectPool(const ObjectPool &) = delete;
+    ObjectPool &operator=(const ObjectPool &) = delete;
+
+    /**
+     * @brief Construct an object in a free slot
+     *
+     * @param args Constructor arguments
+     * @return The new object, which must be passed to release before the pool is destroyed
+     */
+    template <typename... Args>
+    T *acquire(Args &&...args)
+    {
+        if (free_list == nullptr)
+        {
+            grow();
+        }
+        Slot *slot = free_list;
+        free_list = slot->next;
+        T *object = new (slot->storage) T(std::forward<Args>(args)...);
+
+        statistics.allocations++;
+        statistics.bytes_in_use += sizeof(T);
+        if (statistics.bytes_in_use > statistics.peak_bytes)
+        {
+            statistics.peak_bytes = statistics.bytes_in_use;
+        }
+        return object;
+    }
+
+    /**
+     * @brief Destroy an object and return its slot to the pool
+     *
+     * @param object An object acquired from this pool
+     */
+    void release(T *object)
+    {
+        object->~T();
+        Slot *slot = reinterpret_cast<Slot *>(object);
+        slot->next = free_list;
+        free_list = slot;
+        statistics.bytes_in_use -= sizeof(T);
+    }
+
+    /**
+     * @brief Get the usage counters of the pool
+     *
+     * @return The counters
+     */
+    const AllocationStats &stats() const
+    {
+        return statistics;
+    }
+};
+
+#endif // TETRIS_ARENA_H
@@ -0,0 +1,107 @@
+#ifndef TETRIS_BATCH_RUNNER_H
+#define TETRIS_BATCH_RUNNER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+#include "simulator.h"
+
+/**
+ * @brief Creates a policy for one worker thread, so policies can keep per-thread scratch state
+ *
+ */
+using PolicyFactory = std::function<Policy()>;
+
+/**
+ * @brief Aggregate statistics over a set of games. Every field is a sum or a count, so merging is order independent and a batch
+ * produces identical statistics for any thread count.
+ *
+ */
+struct BatchStatistics
+{
+    uint64_t games{0};
+    uint64_t pieces_placed{0};
+    uint64_t lines_cleared{0};
+    uint64_t topped_out{0};
+    uint64_t total_score{0};
+    // Number of pieces which cleared exactly i lines, over every game
+    std::array<uint64_t, kMaxPieceSize + 1> clears_by_size{};
+    // Games whose score fell in [i * score_bucket_width, (i + 1) * score_bucket_width). The last bucket also counts every higher score.
+    std::vector<uint64_t> score_histogram;
+    uint64_t score_bucket_width;
+
+    /**
+     * @brief Create empty statistics
+     *
+     * @param score_bucket_width Width of each score histogram bucket
+     * @param bucket_count Number of score histogram buckets
+     *
+     * @throws std::invalid_argument if score_bucket_width or bucket_count is zero
+     */
+    BatchStatistics(uint64_t score_bucket_width, size_t bucket_count);
+
+    /**
+     * @brief Count one game
+     *
+     * @param result The game
+     */
+    void add(const GameResult &result);
+
+    /**
+     * @brief Add the games counted by other
+     *
+     * @param other Statistics with the same histogram layout
+     *
+     * @throws std::invalid_argument if the histogram layouts differ
+     */
+    void merge(const BatchStatistics &other);
+
+    bool operator==(const BatchStatistics &other) const = default;
+};
+
+/**
+ * @brief Options of a batch run
+ *
+ */
+struct BatchOptions
+{
+    // Number of worker threads. Zero uses one per hardware thread.
+    size_t thread_count{0};
+    // Piece limit of each game
+    uint64_t max_pieces{10000};
+    uint64_t score_bucket_width{10000};
+    size_t bucket_count{100};
+    // Set the pieces are dealt from, or nullptr for the standard set. Must outlive the run.
+    const PieceSet *piece_set{nullptr};
+};
+
+/**
+ * @brief Outcome of a batch run
+ *
+ */
+struct BatchResult
+{
+    BatchStatistics statistics;
+    // Result of every game, in the order of the seeds
+    std::vector<GameResult> games;
+    double seconds;
+};
+
+/**
+ * @brief Play one game per seed, spread across worker threads. Each worker owns its policy and statistics, and claims games from a
+ * shared counter. Each game depends only on its seed, so the results are bit-for-bit identical for any thread count.
+ *
+ * @param seeds Seed of each game
+ * @param make_policy Called once per worker thread to create its policy
+ * @param options Thread count, piece limit and histogram layout
+ * @return Merged statistics and per-game results
+ *
+ * @throws The first exception, by worker index, thrown by a policy factory, policy or game, or std::system_error if a worker thread
+ * cannot be started. Every worker has been joined by the time it is thrown.
+ */
+BatchResult runBatch(std::span<const uint64_t> seeds, const PolicyFactory &make_policy, const BatchOptions &options);
+
+#endif // TETRIS_BATCH_RUNNER_H
@@ -0,0 +1,145 @@
+#ifndef TETRIS_BEAM_SEARCH_H
+#define TETRIS_BEAM_SEARCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "board.h"
+#include "piece.h"
+#include "placement.h"
+#include "search.h"
+#include "thread_pool.h"
+
+/**
+ * @brief Configuration of a BeamSearch
+ *
+ */
+struct BeamOptions
+{
+    // Nodes kept at each layer
+    size_t width{64};
+    // Whether candidates with the same board and lines cleared are merged before selection, keeping the best scoring one
+    bool deduplicate{true};
+    // Beam nodes expanded by each pool task. Zero expands every node on the calling thread.
+    size_t nodes_per_task{8};
+};
+
+/**
+ * @brief Running totals of the work done by a BeamSearch
+ *
+ */
+struct BeamCounters
+{
+    // Beam nodes whose children were generated
+    uint64_t expanded{0};
+    // Children generated and scored
+    uint64_t candidates{0};
+    // Children dropped because an equal node scored at least as well
+    uint64_t duplicates{0};
+    // Children dropped because they did not make the beam
+    uint64_t pruned{0};
+};
+
+/**
+ * @brief Beam search over a known piece sequence, for horizons too long for GameTreeSearch. Each layer places the next piece on every
+ * node of the beam, scores each child with the evaluation function, and keeps only the best width children as the next layer, so time
+ * and memory grow linearly with the number of pieces rather than exponentially. Every buffer is allocated when the search is created: the
+ * beam is a flat structure of arrays holding each node's board, lines cleared and first placement, and each layer's children are
+ * scored in place with make/unmake and stored as a parent index, placement and score until selection copies out only the survivors.
+ * Selection uses nth_element rather than a full sort. Expansion is split across a thread pool; a search object itself must not be used
+ * from several threads at once.
+ *
+ */
+class BeamSearch
+{
+    EvaluationFunction evaluate;
+    ThreadPool &pool;
+    BeamOptions options;
+    BeamCounters beam_counters;
+
+    // The current layer and the one being built, swapped after each piece
+    std::vector<TetrisBoard> boards;
+    std::vector<int> lines;
+    std::vector<Placement> first_placements;
+    std::vector<TetrisBoard> next_boards;
+    std::vector<int> next_lines;
+    std::vector<Placement> next_first_placements;
+
+    // Children of the current layer, kMaxPlacements slots per node. Only the first child_counts[node] slots of a node are used.
+    std::vector<uint16_t> child_counts;
+    std::vector<Placement> child_placements;
+    std::vector<double> child_scores;
+    std::vector<uint64_t> child_keys;
+    std::vector<uint8_t> child_cleared;
+
+    // Indices of the children still in the running for the next layer
+    std::vector<uint32_t> selection;
+
+    // Open addressing table from node key to position in selection, used for deduplication. Slots are valid only when their stamp
+    // matches the current one, so the table never needs clearing.
+    std::vector<uint32_t> dedup_positions;
+    std::vector<uint32_t> dedup_stamps;
+    uint32_t dedup_stamp{0};
+
+    // Piece and size of the layer being expanded, read by the pool tasks so their closures stay small enough not to allocate
+    const TetrisPiece *layer_piece{nullptr};
+    size_t layer_size{0};
+
+    // Generate and score the children of beam nodes [first, last)
+    void expand(size_t first, size_t last);
+
+    // Generate the children of every node of the layer, split across the pool
+    void expandLayer();
+
+    // Merge the first count entries of selection by key, keeping the best scoring child of each key in the position of the first one
+    // seen, and return the number left
+    size_t deduplicate(size_t count);
+
+public:
+    /**
+     * @brief Create a search and allocate its buffers
+     *
+     * @param evaluate Node evaluation function, which must be safe to call from several threads at once
+     * @param pool Pool to expand the beam on
+     * @param options Beam configuration
+     *
+     * @throws std::invalid_argument if the width is zero
+     */
+    BeamSearch(EvaluationFunction evaluate, ThreadPool &pool, BeamOptions options = {});
+
+    /**
+     * @brief Find the best placement of the first piece of a sequence. Nothing is allocated apart from what the pool needs to queue the
+     * expansion tasks.
+     *
+     * @param board The starting board
+     * @param pieces The pieces to place, in order. The search places every one of them.
+     * @return The first placement of the best scoring node of the last layer. Ties go to the placement enumerated first. If every line
+     * tops out before the last piece, the first placement of the best node of the deepest layer reached is returned with a score of
+     * minus infinity.
+     *
+     * @throws std::invalid_argument if pieces is empty
+     */
+    SearchResult search(const TetrisBoard &board, std::span<const TetrisPiece> pieces);
+
+    /**
+     * @brief Get the totals of the work done since the search was created or last reset
+     *
+     * @return The counters
+     */
+    const BeamCounters &counters() const
+    {
+        return beam_counters;
+    }
+
+    /**
+     * @brief Set every counter back to zero
+     *
+     */
+    void resetCounters()
+    {
+        beam_counters = BeamCounters{};
+    }
+};
+
+#endif // TETRIS_BEAM_SEARCH_H
@@ -1,17 +1,916 @@
 #ifndef TETRIS_BOARD_H
 #define TETRIS_BOARD_H
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
 #include "piece.h"
+#include "stats.h"
+#include "zobrist.h"
 
-class TetrisBoard
+/**
+ * @brief Smallest unsigned word holding one bit per column of a board of the given width
+ *
+ */
+template <int Width, typename = void>
+struct BoardRowType
 {
-    int width{10};
-    int height{30};
+    using type = uint64_t;
+};
+
+template <int Width>
+struct BoardRowType<Width, std::enable_if_t<(Width <= 16)>>
+{
+    using type = uint16_t;
+};
+
+template <int Width>
+struct BoardRowType<Width, std::enable_if_t<(Width > 16 && Width <= 32)>>
+{
+    using type = uint32_t;
+};
+
+/**
+ * @brief A board with its dimensions fixed at compile time, so every loop over its rows and columns has a constant trip count. Rows are
+ * stored in the smallest word that fits the width: 16 bits up to 16 columns, 32 up to 32 and 64 beyond. Boards whose size is only known
+ * at run time use DynamicTetrisBoard instead.
+ *
+ * @tparam Width Number of columns, at most kZobristMaxColumns
+ * @tparam Height Number of rows, at most kZobristMaxRows
+ */
+template <int Width, int Height>
+class BasicTetrisBoard
+{
+public:
+    static constexpr int width{Width};
+    static constexpr int height{Height};
+
+    /**
+     * @brief A single row of the board, with bit i set if column i is filled
+     *
+     */
+    using Row = typename BoardRowType<Width>::type;
+
+    /**
+     * @brief Value of a row with every column filled
+     *
+     */
+    static constexpr Row kFullRow = std::numeric_limits<Row>::max() >> (std::numeric_limits<Row>::digits - width);
+    static_assert(width > 0 && height > 0, "Board must have at least one row and column");
+    static_assert(width <= kZobristMaxColumns && height <= kZobristMaxRows, "Board does not fit the Zobrist key table");
+
+    /**
+     * @brief One bit per row, used to record which rows a line clear removes
+     *
+     */
+    using RowMask = std::conditional_t<(Height <= 32), uint32_t, uint64_t>;
+
+    /**
+     * @brief Everything unmakeMove needs to take a move back exactly: where the piece landed, which rows it cleared, and the metrics it
+     * replaced. Filled in by makeMove.
+     *
+     */
+    struct UndoRecord
+    {
+        // Cells of the piece and the board position of its bottom left corner
+        uint64_t piece_cells;
+        uint8_t piece_height;
+        uint8_t col_offset;
+        uint8_t row_offset;
+        // Rows removed by the move, numbered as they were before the clear
+        RowMask cleared_rows;
+        // Metrics from before the move
+        std::array<uint8_t, width> column_heights;
+        std::array<uint8_t, width> column_cells;
+        uint8_t max_height;
+        uint16_t hole_count;
+        uint64_t hash;
+    };
+
+private:
+
+    // Row zero is the bottom of the board
+    std::array<Row, height> rows{};
+
+    // Per column metrics, kept up to date by addPiece and clearLines. A column's height is one past its highest filled cell.
+    std::array<uint8_t, width> column_heights{};
+    std::array<uint8_t, width> column_cells{};
+    int max_height{0};
+    int hole_count{0};
+
+    // Zobrist hash of the filled cells, kept up to date by addPiece and clearLines
+    uint64_t hash_value{0};
+
+    // Whether any row of the piece placed with its bottom left corner at (col_offset, row_offset) overlaps a filled cell. Rows above the board are treated as empty.
+    bool overlaps(const TetrisPiece &piece, int col_offset, int row_offset) const;
+
+    // Remove the full rows among the given rows, shift everything above them down and update the column metrics. Returns the rows removed.
+    RowMask clearLines(int first_row, int last_row);
+
+    // Remove the given rows, which must all be full and below max_height, in one pass over the rows above the lowest of them
+    void removeFullRows(RowMask cleared_mask);
+
+public:
+    /**
+     * @brief Create an empty board
+     *
+     */
+    BasicTetrisBoard() = default;
+
+    /**
+     * @brief Create a board with the given cells, computing every metric from scratch
+     *
+     * @param board_rows One bitmask per row, starting from the bottom
+     *
+     * @throws std::invalid_argument if board_rows does not hold exactly height rows, or a row has bits set beyond the width of the board
+     */
+    explicit BasicTetrisBoard(std::span<const Row> board_rows);
+
+    /**
+     * @brief Drop a piece straight down from above the board and lock it in place, clearing any rows it completes
+     *
+     * @param piece The piece to drop
+     * @param col_offset The board column of the left edge of the piece
+     * @return The number of lines cleared
+     *
+     * @throws std::out_of_range if the piece does not fit horizontally at col_offset
+     * @throws std::overflow_error if the piece would land above the top of the board
+     */
+    int addPiece(const TetrisPiece &piece, int col_offset);
+
+    /**
+     * @brief Drop a piece as addPiece does, recording how to take it back. Searches make and unmake moves on one board rather than
+     * copying the board at every node.
+     *
+     * @param piece The piece to drop
+     * @param col_offset The board column of the left edge of the piece
+     * @param undo Filled in with the record to pass to unmakeMove. Left untouched if the move throws.
+     * @return The number of lines cleared
+     *
+     * @throws std::out_of_range if the piece does not fit horizontally at col_offset
+     * @throws std::overflow_error if the piece would land above the top of the board
+     */
+    int makeMove(const TetrisPiece &piece, int col_offset, UndoRecord &undo);
+
+    /**
+     * @brief Restore the board to exactly the state before a move, including its metrics and hash. Moves must be unmade in the reverse
+     * order they were made; making the same move again redoes it.
+     *
+     * @param undo The record filled in by the most recent makeMove not yet unmade
+     */
+    void unmakeMove(const UndoRecord &undo);
+
+    /**
+     * @brief Find every full row. Boards only hold full rows when created from rows or before a pending clearRows.
+     *
+     * @return A mask with bit i set if row i is full
+     */
+    RowMask fullRows() const;
+
+    /**
+     * @brief Remove any set of full rows at once, shifting the rows above them down in a single pass
+     *
+     * @param rows_to_clear A mask with bit i set if row i should be removed
+     * @return The number of rows removed
+     *
+     * @throws std::invalid_argument if any of the rows is not full
+     */
+    int clearRows(RowMask rows_to_clear);
 
+    /**
+     * @brief Push garbage rows in from the bottom of the board, as sent by an opponent in versus play. Every garbage row is full except
+     * for the hole column. The existing rows move up in a single pass.
+     *
+     * @param count Number of rows to insert
+     * @param hole_column The column left empty in every inserted row
+     *
+     * @throws std::invalid_argument if count is negative
+     * @throws std::out_of_range if hole_column is not a valid column
+     * @throws std::overflow_error if the stack would be pushed above the top of the board. The board is left unchanged.
+     */
+    void insertGarbage(int count, int hole_column);
+
+    /**
+     * @brief Determine the row the bottom of a piece would come to rest in if dropped at the given column, in O(piece width) from the piece skirt and the column heights.
+     * The result may leave part of the piece above the board.
+     *
+     * @param piece The piece to drop
+     * @param col_offset The board column of the left edge of the piece, which must be valid for the piece
+     * @return The landing row of the bottom of the piece
+     */
+    int landingRow(const TetrisPiece &piece, int col_offset) const;
+
+    /**
+     * @brief Determine whether a piece placed with its bottom left corner at the given position overlaps filled cells or the edges of the board
+     *
+     * @param piece The piece to test
+     * @param col_offset The board column of the left edge of the piece
+     * @param row_offset The board row of the bottom edge of the piece
+     * @return true If the piece cannot occupy that position
+     * @return false If every cell of the piece is inside the board and empty
+     */
+    bool collides(const TetrisPiece &piece, int col_offset, int row_offset) const;
+
+    /**
+     * @brief Determine the height of the tallest column in O(1)
+     *
+     * @return The number of rows up to and including the highest filled cell, or zero for an empty board
+     */
+    int maxHeight() const
+    {
+        return max_height;
+    }
+
+    /**
+     * @brief Determine the height of the highest block in the given column in O(1)
+     *
+     * @param col_idx The index of the column
+     * @return The row of the highest filled cell in the column (zero indexed), or -1 if the column is empty
+     *
+     * @throws std::out_of_range if col_idx is not a valid column
+     */
+    int highestBlockInColumn(int col_idx) const;
+
+    /**
+     * @brief Determine the height of the given column in O(1). No bounds checking is performed.
+     *
+     * @param col_idx The index of the column
+     * @return The number of rows up to and including the highest filled cell in the column, or zero if it is empty
+     */
+    int columnHeight(int col_idx) const
+    {
+        return column_heights[col_idx];
+    }
+
+    /**
+     * @brief Determine the number of holes (empty cells below the highest filled cell) in the given column in O(1). No bounds checking is performed.
+     *
+     * @param col_idx The index of the column
+     * @return The number of holes in the column
+     */
+    int holesInColumn(int col_idx) const
+    {
+        return column_heights[col_idx] - column_cells[col_idx];
+    }
+
+    /**
+     * @brief Determine the total number of holes on the board in O(1)
+     *
+     * @return The number of empty cells which lie below the highest filled cell of their column
+     */
+    int holes() const
+    {
+        return hole_count;
+    }
+
+    /**
+     * @brief Get the Zobrist hash of the board in O(1). Equal boards always have equal hashes.
+     *
+     * @return The XOR of the Zobrist keys of every filled cell
+     */
+    uint64_t hash() const
+    {
+        return hash_value;
+    }
+
+    /**
+     * @brief Get the given row of the board as a bitmask. No bounds checking is performed.
+     *
+     * @param row_idx The row to get (zero is the bottom of the board)
+     * @return The row bitmask
+     */
+    Row row(int row_idx) const
+    {
+        return rows[row_idx];
+    }
+
+    /**
+     * @brief Determine whether the cell at the given position is filled. No bounds checking is performed.
+     *
+     * @param col_idx The column of the cell
+     * @param row_idx The row of the cell (zero is the bottom of the board)
+     * @return true If the cell is filled
+     * @return false If the cell is empty
+     */
+    bool at(int col_idx, int row_idx) const
+    {
+        return (rows[row_idx] >> col_idx) & 1;
+    }
+
+    /**
+     * @brief Compare two boards
+     *
+     * @param b The board to compare against
+     * @return true If every cell of the two boards matches
+     * @return false Otherwise
+     */
+    bool operator==(const BasicTetrisBoard &b) const
+    {
+        return rows == b.rows;
+    }
+};
+
+/**
+ * @brief Fallback board for sizes only known at run time, with the same interface as BasicTetrisBoard apart from width and height
+ * being member functions. Rows are always 64 bit words and line clears rescan the columns, so prefer BasicTetrisBoard whenever the size
+ * is known at compile time.
+ *
+ */
+class DynamicTetrisBoard
+{
 public:
-    void addPiece(TetrisPiece piece, int col_offset);
-    int maxHeight();
-    int highestBlockInColumn();
+    using Row = uint64_t;
+
+private:
+    int board_width;
+    int board_height;
+    Row full_row;
+
+    // Row zero is the bottom of the board
+    std::vector<Row> rows;
+    std::vector<uint8_t> column_heights;
+    std::vector<uint8_t> column_cells;
+    int max_height{0};
+    int hole_count{0};
+    uint64_t hash_value{0};
+
+    // Remove the full rows among the given rows and shift everything above them down. Returns the rows removed.
+    Row clearLines(int first_row, int last_row);
+
+    // Recompute every column metric and the hash from the rows
+    void rescan();
+
+public:
+    /**
+     * @brief Everything unmakeMove needs to take a move back. Only the heights of the columns under the piece are kept, since undoing a
+     * line clear rescans the board.
+     *
+     */
+    struct UndoRecord
+    {
+        uint64_t piece_cells;
+        uint8_t piece_width;
+        uint8_t piece_height;
+        uint8_t col_offset;
+        uint8_t row_offset;
+        // Rows removed by the move, numbered as they were before the clear
+        Row cleared_rows;
+        std::array<uint8_t, kMaxPieceSize> column_heights;
+        int max_height;
+        int hole_count;
+        uint64_t hash;
+    };
+
+public:
+    /**
+     * @brief Create an empty board
+     *
+     * @param width Number of columns, between one and kZobristMaxColumns
+     * @param height Number of rows, between one and kZobristMaxRows
+     *
+     * @throws std::invalid_argument if either dimension is out of range
+     */
+    DynamicTetrisBoard(int width, int height);
+
+    int width() const
+    {
+        return board_width;
+    }
+
+    int height() const
+    {
+        return board_height;
+    }
+
+    /**
+     * @brief Drop a piece straight down from above the board and lock it in place, clearing any rows it completes
+     *
+     * @param piece The piece to drop
+     * @param col_offset The board column of the left edge of the piece
+     * @return The number of lines cleared
+     *
+     * @throws std::out_of_range if the piece does not fit horizontally at col_offset
+     * @throws std::overflow_error if the piece would land above the top of the board
+     */
+    int addPiece(const TetrisPiece &piece, int col_offset);
+
+    /**
+     * @brief Drop a piece as addPiece does, recording how to take it back
+     *
+     * @param piece The piece to drop
+     * @param col_offset The board column of the left edge of the piece
+     * @param undo Filled in with the record to pass to unmakeMove. Left untouched if the move throws.
+     * @return The number of lines cleared
+     *
+     * @throws std::out_of_range if the piece does not fit horizontally at col_offset
+     * @throws std::overflow_error if the piece would land above the top of the board
+     */
+    int makeMove(const TetrisPiece &piece, int col_offset, UndoRecord &undo);
+
+    /**
+     * @brief Restore the board to exactly the state before a move. Moves must be unmade in the reverse order they were made.
+     *
+     * @param undo The record filled in by the most recent makeMove not yet unmade
+     */
+    void unmakeMove(const UndoRecord &undo);
+
+    /**
+     * @brief Find every full row
+     *
+     * @return A mask with bit i set if row i is full
+     */
+    Row fullRows() const;
+
+    /**
+     * @brief Remove any set of full rows at once, shifting the rows above them down in a single pass
+     *
+     * @param rows_to_clear A mask with bit i set if row i should be removed
+     * @return The number of rows removed
+     *
+     * @throws std::invalid_argument if any of the rows is not full
+     */
+    int clearRows(Row rows_to_clear);
+
+    /**
+     * @brief Push garbage rows in from the bottom of the board, each full except for the hole column
+     *
+     * @param count Number of rows to insert
+     * @param hole_column The column left empty in every inserted row
+     *
+     * @throws std::invalid_argument if count is negative
+     * @throws std::out_of_range if hole_column is not a valid column
+     * @throws std::overflow_error if the stack would be pushed above the top of the board. The board is left unchanged.
+     */
+    void insertGarbage(int count, int hole_column);
+
+    /**
+     * @brief Determine the row the bottom of a piece would come to rest in if dropped at the given column
+     *
+     * @param piece The piece to drop
+     * @param col_offset The board column of the left edge of the piece, which must be valid for the piece
+     * @return The landing row of the bottom of the piece
+     */
+    int landingRow(const TetrisPiece &piece, int col_offset) const;
+
+    /**
+     * @brief Determine whether a piece placed with its bottom left corner at the given position overlaps filled cells or the edges of the board
+     *
+     * @param piece The piece to test
+     * @param col_offset The board column of the left edge of the piece
+     * @param row_offset The board row of the bottom edge of the piece
+     * @return true If the piece cannot occupy that position
+     * @return false If every cell of the piece is inside the board and empty
+     */
+    bool collides(const TetrisPiece &piece, int col_offset, int row_offset) const;
+
+    int maxHeight() const
+    {
+        return max_height;
+    }
+
+    /**
+     * @brief Determine the height of the highest block in the given column
+     *
+     * @param col_idx The index of the column
+     * @return The row of the highest filled cell in the column (zero indexed), or -1 if the column is empty
+     *
+     * @throws std::out_of_range if col_idx is not a valid column
+     */
+    int highestBlockInColumn(int col_idx) const;
+
+    int columnHeight(int col_idx) const
+    {
+        return column_heights[col_idx];
+    }
+
+    int holesInColumn(int col_idx) const
+    {
+        return column_heights[col_idx] - column_cells[col_idx];
+    }
+
+    int holes() const
+    {
+        return hole_count;
+    }
+
+    uint64_t hash() const
+    {
+        return hash_value;
+    }
+
+    Row row(int row_idx) const
+    {
+        return rows[row_idx];
+    }
+
+    bool at(int col_idx, int row_idx) const
+    {
+        return (rows[row_idx] >> col_idx) & 1;
+    }
+
+    bool operator==(const DynamicTetrisBoard &b) const
+    {
+        return board_width == b.board_width && rows == b.rows;
+    }
+
+    /**
+     * @brief Output a string representation of a tetris board to the given output stream
+     *
+     * @param outs reference to the output stream
+     * @param board reference to the tetris board
+     * @return std::ostream& the provided output stream
+     */
+    friend std::ostream &operator<<(std::ostream &outs, const DynamicTetrisBoard &board);
 };
 
-#endif // TETRIS_BOARD_H
\ No newline at end of file
+/**
+ * @brief The standard 10 wide, 30 tall board
+ *
+ */
+using TetrisBoard = BasicTetrisBoard<10, 30>;
+
+template <int Width, int Height>
+BasicTetrisBoard<Width, Height>::BasicTetrisBoard(std::span<const Row> board_rows)
+{
+    if (board_rows.size() != static_cast<size_t>(height))
+    {
+        throw std::invalid_argument("Board must be created from exactly height rows");
+    }
+
+    for (int row_idx = 0; row_idx < height; row_idx++)
+    {
+        if (board_rows[row_idx] & ~kFullRow)
+        {
+            throw std::invalid_argument("Board row has cells beyond the width of the board");
+        }
+        rows[row_idx] = board_rows[row_idx];
+        hash_value ^= zobristRow(row_idx, rows[row_idx]);
+        for (int col_idx = 0; col_idx < width; col_idx++)
+        {
+            if ((rows[row_idx] >> col_idx) & 1)
+            {
+                column_heights[col_idx] = row_idx + 1;
+                column_cells[col_idx]++;
+            }
+        }
+    }
+
+    for (int col_idx = 0; col_idx < width; col_idx++)
+    {
+        hole_count += holesInColumn(col_idx);
+        max_height = std::max<int>(max_height, column_heights[col_idx]);
+    }
+}
+
+template <int Width, int Height>
+bool BasicTetrisBoard<Width, Height>::overlaps(const TetrisPiece &piece, int col_offset, int row_offset) const
+{
+    int rows_on_board = std::min<int>(piece.height, height - row_offset);
+    Row hit = 0;
+    for (int row_idx = 0; row_idx < rows_on_board; row_idx++)
+    {
+        hit |= rows[row_offset + row_idx] & (Row{piece.row(row_idx)} << col_offset);
+    }
+    return hit != 0;
+}
+
+template <int Width, int Height>
+bool BasicTetrisBoard<Width, Height>::collides(const TetrisPiece &piece, int col_offset, int row_offset) const
+{
+    countStat(StatCounter::CollisionChecks);
+    if (col_offset < 0 || row_offset < 0 || col_offset + piece.width > width || row_offset + piece.height > height)
+    {
+        return true;
+    }
+    return overlaps(piece, col_offset, row_offset);
+}
+
+template <int Width, int Height>
+int BasicTetrisBoard<Width, Height>::landingRow(const TetrisPiece &piece, int col_offset) const
+{
+    // The piece stops as soon as the bottom of any of its columns reaches the top of the board column below it.
+    // Empty piece columns have a skirt of kNoBlock, which never wins the max.
+    int row_idx = 0;
+    for (int piece_col = 0; piece_col < piece.width; piece_col++)
+    {
+        row_idx = std::max(row_idx, column_heights[col_offset + piece_col] - piece.skirt[piece_col]);
+    }
+    return row_idx;
+}
+
+template <int Width, int Height>
+int BasicTetrisBoard<Width, Height>::addPiece(const TetrisPiece &piece, int col_offset)
+{
+    UndoRecord undo;
+    return makeMove(piece, col_offset, undo);
+}
+
+template <int Width, int Height>
+int BasicTetrisBoard<Width, Height>::makeMove(const TetrisPiece &piece, int col_offset, UndoRecord &undo)
+{
+    countStat(StatCounter::AddPiece);
+    ScopedStatTimer timer(StatTimer::AddPiece);
+    if (col_offset < 0 || col_offset + piece.width > width)
+    {
+        throw std::out_of_range("Piece does not fit on the board at the given column");
+    }
+
+    int row_offset = landingRow(piece, col_offset);
+    if (row_offset + piece.height > height)
+    {
+        throw std::overflow_error("Piece lands above the top of the board");
+    }
+    undo.piece_cells = piece.cells;
+    undo.piece_height = piece.height;
+    undo.col_offset = static_cast<uint8_t>(col_offset);
+    undo.row_offset = static_cast<uint8_t>(row_offset);
+    undo.column_heights = column_heights;
+    undo.column_cells = column_cells;
+    undo.max_height = static_cast<uint8_t>(max_height);
+    undo.hole_count = static_cast<uint16_t>(hole_count);
+    undo.hash = hash_value;
+
+    for (int row_idx = 0; row_idx < piece.height; row_idx++)
+    {
+        Row piece_row = Row{piece.row(row_idx)} << col_offset;
+        rows[row_offset + row_idx] |= piece_row;
+        hash_value ^= zobristRow(row_offset + row_idx, piece_row);
+    }
+
+    // Update the metrics of the columns the piece covers
+    for (int piece_col = 0; piece_col < piece.width; piece_col++)
+    {
+        uint64_t column = (piece.cells >> piece_col) & kPieceColumnMask;
+        if (column == 0)
+        {
+            continue;
+        }
+        int col_idx = col_offset + piece_col;
+        int old_holes = holesInColumn(col_idx);
+        column_heights[col_idx] = std::max<int>(column_heights[col_idx], row_offset + piece.top[piece_col]);
+        column_cells[col_idx] += std::popcount(column);
+        hole_count += holesInColumn(col_idx) - old_holes;
+        max_height = std::max<int>(max_height, column_heights[col_idx]);
+    }
+
+    // Only the rows the piece touched can have been completed
+    undo.cleared_rows = clearLines(row_offset, row_offset + piece.height - 1);
+    return undo.cleared_rows != 0 ? std::popcount(undo.cleared_rows) : 0;
+}
+
+template <int Width, int Height>
+void BasicTetrisBoard<Width, Height>::unmakeMove(const UndoRecord &undo)
+{
+    if (undo.cleared_rows != 0)
+    {
+        // Move the rows above each cleared row back up and refill it. Working from the top down reads every row before it is overwritten.
+        int top = std::max<int>(undo.max_height, undo.row_offset + undo.piece_height);
+        int shift = std::popcount(undo.cleared_rows);
+        for (int row_idx = top - 1; shift > 0; row_idx--)
+        {
+            if ((undo.cleared_rows >> row_idx) & 1)
+            {
+                rows[row_idx] = kFullRow;
+                shift--;
+            }
+            else
+            {
+                rows[row_idx] = rows[row_idx - shift];
+            }
+        }
+    }
+
+    for (int row_idx = 0; row_idx < undo.piece_height; row_idx++)
+    {
+        rows[undo.row_offset + row_idx] ^= Row{static_cast<uint8_t>(undo.piece_cells >> (row_idx * kMaxPieceSize))} << undo.col_offset;
+    }
+    column_heights = undo.column_heights;
+    column_cells = undo.column_cells;
+    max_height = undo.max_height;
+    hole_count = undo.hole_count;
+    hash_value = undo.hash;
+}
+
+template <int Width, int Height>
+typename BasicTetrisBoard<Width, Height>::RowMask BasicTetrisBoard<Width, Height>::clearLines(int first_row, int last_row)
+{
+    // Find the lowest full row, if any
+    int first_full = first_row;
+    while (first_full <= last_row && rows[first_full] != kFullRow)
+    {
+        first_full++;
+    }
+    if (first_full > last_row)
+    {
+        return 0;
+    }
+
+    // Record which rows are being removed, for the column height updates
+    RowMask cleared_mask = 0;
+    for (int row_idx = first_full; row_idx <= last_row; row_idx++)
+    {
+        cleared_mask |= RowMask{rows[row_idx] == kFullRow} << row_idx;
+    }
+    removeFullRows(cleared_mask);
+    return cleared_mask;
+}
+
+template <int Width, int Height>
+void BasicTetrisBoard<Width, Height>::removeFullRows(RowMask cleared_mask)
+{
+    ScopedStatTimer timer(StatTimer::LineClear);
+    int first_full = std::countr_zero(cleared_mask);
+
+    // Every row from the first cleared one up moves, so take their old contents out of the hash
+    for (int row_idx = first_full; row_idx < max_height; row_idx++)
+    {
+        hash_value ^= zobristRow(row_idx, rows[row_idx]);
+    }
+
+    // Compact the remaining rows downwards, always copying and only advancing past rows that are kept
+    int write_idx = first_full;
+    for (int read_idx = first_full; read_idx < max_height; read_idx++)
+    {
+        rows[write_idx] = rows[read_idx];
+        write_idx += !((cleared_mask >> read_idx) & 1);
+    }
+    int cleared = max_height - write_idx;
+    for (int row_idx = first_full; row_idx < write_idx; row_idx++)
+    {
+        hash_value ^= zobristRow(row_idx, rows[row_idx]);
+    }
+    for (; write_idx < max_height; write_idx++)
+    {
+        rows[write_idx] = 0;
+    }
+
+    // Every column loses one cell per cleared row, and drops by the number of cleared rows below its top.
+    // Only when the top cell itself was cleared does the column need to search downwards for its new top.
+    int new_max_height = 0;
+    hole_count = 0;
+    for (int col_idx = 0; col_idx < width; col_idx++)
+    {
+        int col_height = column_heights[col_idx];
+        // A column can only be as tall as the mask is wide when the board is exactly 32 or 64 rows tall
+        RowMask below_top = ~RowMask{0};
+        if (Height < std::numeric_limits<RowMask>::digits || col_height < Height)
+        {
+            below_top = (RowMask{1} << col_height) - 1;
+        }
+        int cleared_below = std::popcount(static_cast<RowMask>(cleared_mask & below_top));
+        bool top_cleared = col_height > 0 && ((cleared_mask >> (col_height - 1)) & 1);
+        col_height -= cleared_below;
+        if (top_cleared)
+        {
+            Row column_bit = Row{1} << col_idx;
+            while (col_height > 0 && !(rows[col_height - 1] & column_bit))
+            {
+                col_height--;
+            }
+        }
+        column_heights[col_idx] = col_height;
+        column_cells[col_idx] -= cleared;
+        hole_count += holesInColumn(col_idx);
+        new_max_height = std::max(new_max_height, col_height);
+    }
+    max_height = new_max_height;
+    countStat(StatCounter::LineClears);
+    countStat(StatCounter::LinesCleared, cleared);
+}
+
+
+template <int Width, int Height>
+typename BasicTetrisBoard<Width, Height>::RowMask BasicTetrisBoard<Width, Height>::fullRows() const
+{
+    RowMask full = 0;
+    for (int row_idx = 0; row_idx < max_height; row_idx++)
+    {
+        full |= RowMask{rows[row_idx] == kFullRow} << row_idx;
+    }
+    return full;
+}
+
+template <int Width, int Height>
+int BasicTetrisBoard<Width, Height>::clearRows(RowMask rows_to_clear)
+{
+    if (rows_to_clear == 0)
+    {
+        return 0;
+    }
+    if ((rows_to_clear & ~fullRows()) != 0)
+    {
+        throw std::invalid_argument("Only full rows can be cleared");
+    }
+    removeFullRows(rows_to_clear);
+    return std::popcount(rows_to_clear);
+}
+
+template <int Width, int Height>
+void BasicTetrisBoard<Width, Height>::insertGarbage(int count, int hole_column)
+{
+    if (count < 0)
+    {
+        throw std::invalid_argument("Garbage row count must not be negative");
+    }
+    if (hole_column < 0 || hole_column >= width)
+    {
+        throw std::out_of_range("Garbage hole column out of range");
+    }
+    if (max_height + count > height)
+    {
+        throw std::overflow_error("Garbage pushes the stack above the top of the board");
+    }
+    if (count == 0)
+    {
+        return;
+    }
+
+    // Move the stack up from the top down, then fill in the garbage underneath it. Every cell changes position, so rehash as we go.
+    Row garbage = kFullRow & ~(Row{1} << hole_column);
+    hash_value = 0;
+    for (int row_idx = max_height + count - 1; row_idx >= count; row_idx--)
+    {
+        rows[row_idx] = rows[row_idx - count];
+        hash_value ^= zobristRow(row_idx, rows[row_idx]);
+    }
+    for (int row_idx = 0; row_idx < count; row_idx++)
+    {
+        rows[row_idx] = garbage;
+        hash_value ^= zobristRow(row_idx, garbage);
+    }
+
+    // Every column rises by count and gains count cells, except that the hole column gains no cells and stays empty if it was
+    max_height = 0;
+    hole_count = 0;
+    for (int col_idx = 0; col_idx < width; col_idx++)
+    {
+        if (col_idx != hole_column || column_heights[col_idx] > 0)
+        {
+            column_heights[col_idx] += count;
+        }
+        if (col_idx != hole_column)
+        {
+            column_cells[col_idx] += count;
+        }
+        hole_count += holesInColumn(col_idx);
+        max_height = std::max<int>(max_height, column_heights[col_idx]);
+    }
+}
+
+template <int Width, int Height>
+int BasicTetrisBoard<Width, Height>::highestBlockInColumn(int col_idx) const
+{
+    if (col_idx < 0 || col_idx >= width)
+    {
+        throw std::out_of_range("Column index out of range");
+    }
+
+    return column_heights[col_idx] - 1;
+}
+
+/**
+ * @brief Output a string representation of a tetris board to the given output stream
+ *
+ * @param outs reference to the output stream
+ * @param board reference to the tetris board
+ * @return std::ostream& the provided output stream
+ */
+template <int Width, int Height>
+std::ostream &operator<<(std::ostream &outs, const BasicTetrisBoard<Width, Height> &board)
+{
+    std::string horizontal_bar(Width + 2, '-');
+    horizontal_bar += '\n';
+    outs << horizontal_bar;
+    for (int row_idx = Height; row_idx-- > 0;)
+    {
+        outs << '|';
+        for (int col_idx = 0; col_idx < Width; col_idx++)
+        {
+            if (board.at(col_idx, row_idx))
+            {
+                outs << 'X';
+            }
+            else
+            {
+                outs << ' ';
+            }
+        }
+        outs << "|\n";
+    }
+    outs << horizontal_bar;
+    return outs;
+}
+
+// The standard board is compiled once, in board.cpp
+extern template class BasicTetrisBoard<10, 30>;
+extern template std::ostream &operator<<(std::ostream &outs, const TetrisBoard &board);
+
+#endif // TETRIS_BOARD_H
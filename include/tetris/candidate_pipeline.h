@@ -0,0 +1,148 @@
+#ifndef TETRIS_CANDIDATE_PIPELINE_H
+#define TETRIS_CANDIDATE_PIPELINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include "board.h"
+#include "evaluation.h"
+#include "piece.h"
+#include "placement.h"
+#include "search.h"
+#include "simulator.h"
+
+/**
+ * @brief Estimate the features of the board a placement would produce, from the piece's skirt and top and the board's column heights
+ * alone, without copying the board or placing the piece. Holes are the holes already on the board plus the gaps left between each column
+ * and the skirt of the piece. Completed lines are exact. When no line is completed the aggregate height, holes and max height are exact
+ * as well; when lines are completed every column is assumed to drop by the number of lines and no hole is assumed to be opened. Bumpiness
+ * is not estimated and is always zero.
+ *
+ * @param board The board
+ * @param piece The piece, in the orientation of the placement
+ * @param placement A placement of the piece on the board, as reported by enumeratePlacements
+ * @return The estimated features
+ */
+BoardFeatures estimateFeatures(const TetrisBoard &board, const TetrisPiece &piece, const Placement &placement);
+
+/**
+ * @brief Configuration of the stages of a CandidatePipeline
+ *
+ */
+struct PipelineOptions
+{
+    // Whether stage one bounds every candidate and stage two filters them. When false every candidate is fully evaluated.
+    bool prune{true};
+    // Number of candidates with the best estimates passed on to the full evaluation. Zero passes every candidate on. Stages one and two
+    // are skipped when a piece has no more placements than this.
+    size_t keep{4};
+};
+
+/**
+ * @brief Number of candidates which reached each stage of a CandidatePipeline
+ *
+ */
+struct PipelineCounters
+{
+    // Placements enumerated
+    uint64_t enumerated{0};
+    // Placements given a stage one estimate
+    uint64_t estimated{0};
+    // Placements dropped by the stage two filter
+    uint64_t pruned{0};
+    // Placements given the full evaluation
+    uint64_t evaluated{0};
+
+    PipelineCounters &operator+=(const PipelineCounters &other);
+};
+
+/**
+ * @brief A placement and its scores in a CandidatePipeline
+ *
+ */
+struct ScoredCandidate
+{
+    Placement placement;
+    // Stage one estimate, or zero if the candidate skipped stage one
+    float estimate;
+    // Full evaluation
+    double score;
+};
+
+/**
+ * @brief Chooses a placement in three stages, so that expensive evaluations are spent only on plausible moves. Stage one scores every
+ * placement with estimateFeatures and the estimate weights; stage two keeps the best few estimates; stage three places each survivor on
+ * a board and scores the result with the evaluation function, which may be a plain heuristic or a deeper search. A pipeline keeps
+ * running counts of how many candidates reached each stage. It is not safe to share between threads.
+ *
+ */
+class CandidatePipeline
+{
+    FeatureWeights estimate_weights;
+    EvaluationFunction evaluate;
+    PipelineOptions options;
+    PipelineCounters stage_counters;
+
+public:
+    /**
+     * @brief Create a pipeline
+     *
+     * @param estimate_weights Weights of the stage one estimate
+     * @param evaluate Full evaluation of the board after a survivor has been placed, given the lines that placement cleared
+     * @param options Stage configuration
+     */
+    CandidatePipeline(const FeatureWeights &estimate_weights, EvaluationFunction evaluate, PipelineOptions options = {});
+
+    /**
+     * @brief Run stages one and two: enumerate the placements of a piece and keep those with the best estimates. Does not allocate.
+     *
+     * @param board The board
+     * @param piece The piece to place, in any orientation
+     * @param out Buffer for the survivors, in order of enumeration
+     * @return The number of survivors written
+     *
+     * @throws std::invalid_argument if out holds fewer than kMaxPlacements entries
+     */
+    size_t survivors(const TetrisBoard &board, const TetrisPiece &piece, std::span<ScoredCandidate> out);
+
+    /**
+     * @brief Run every stage and return the survivor with the best full evaluation
+     *
+     * @param board The board
+     * @param piece The piece to place, in any orientation
+     * @return The best candidate, or std::nullopt if the piece has no placement. Ties go to the placement enumerated first.
+     */
+    std::optional<ScoredCandidate> best(const TetrisBoard &board, const TetrisPiece &piece);
+
+    /**
+     * @brief Get the counts of candidates which reached each stage since the pipeline was created or last reset
+     *
+     * @return The counters
+     */
+    const PipelineCounters &counters() const
+    {
+        return stage_counters;
+    }
+
+    /**
+     * @brief Set every counter back to zero
+     *
+     */
+    void resetCounters()
+    {
+        stage_counters = PipelineCounters{};
+    }
+};
+
+/**
+ * @brief Create a policy which runs a CandidatePipeline whose estimate and full evaluation both use the same weights. The policy owns its
+ * pipeline, so it must not be called from several threads at once; give each thread its own, as runBatch does.
+ *
+ * @param weights Feature weights
+ * @param options Stage configuration
+ * @return The policy
+ */
+Policy pipelinePolicy(const FeatureWeights &weights, PipelineOptions options = {});
+
+#endif // TETRIS_CANDIDATE_PIPELINE_H
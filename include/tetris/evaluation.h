@@ -0,0 +1,148 @@
+#ifndef TETRIS_EVALUATION_H
+#define TETRIS_EVALUATION_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "board.h"
+
+/**
+ * @brief Number of boards evaluated together by evaluateBatch, one per 32 bit lane of an AVX2 register
+ *
+ */
+constexpr size_t kBatchSize = 8;
+
+/**
+ * @brief Heuristic features of a single board
+ *
+ */
+struct BoardFeatures
+{
+    // Sum of the column heights
+    int aggregate_height;
+    // Sum of the absolute height differences of neighbouring columns
+    int bumpiness;
+    // Empty cells below the top of their column
+    int holes;
+    // Lines cleared by the move which produced the board
+    int completed_lines;
+    // Height of the tallest column
+    int max_height;
+};
+
+/**
+ * @brief Weight of each feature in a board score. The score is the sum of each feature times its weight.
+ *
+ */
+struct FeatureWeights
+{
+    float aggregate_height;
+    float bumpiness;
+    float holes;
+    float completed_lines;
+    float max_height;
+};
+
+/**
+ * @brief Struct-of-arrays pack of up to kBatchSize boards, holding only the per-board data the features are computed from
+ *
+ */
+struct BoardBatch
+{
+    alignas(32) std::array<std::array<int32_t, kBatchSize>, TetrisBoard::width> column_heights{};
+    alignas(32) std::array<int32_t, kBatchSize> holes{};
+    alignas(32) std::array<int32_t, kBatchSize> completed_lines{};
+    // One more than the highest lane loaded since the batch was created or cleared. Lanes never loaded in that time hold empty boards
+    // and are evaluated as such; the kernels always evaluate every lane.
+    size_t count{0};
+
+    /**
+     * @brief Load a board into a lane
+     *
+     * @param lane The lane to load, which must be less than kBatchSize
+     * @param board The board
+     * @param lines_cleared Lines cleared by the move which produced the board
+     */
+    void set(size_t lane, const TetrisBoard &board, int lines_cleared);
+
+    /**
+     * @brief Reset every lane to an empty board and count to zero, so a reused batch holding fewer boards than before does not
+     * evaluate the boards it held last time
+     *
+     */
+    void clear()
+    {
+        *this = BoardBatch{};
+    }
+};
+
+/**
+ * @brief Features and scores of every lane of a BoardBatch
+ *
+ */
+struct FeatureBatch
+{
+    alignas(32) std::array<int32_t, kBatchSize> aggregate_height{};
+    alignas(32) std::array<int32_t, kBatchSize> bumpiness{};
+    alignas(32) std::array<int32_t, kBatchSize> holes{};
+    alignas(32) std::array<int32_t, kBatchSize> completed_lines{};
+    alignas(32) std::array<int32_t, kBatchSize> max_height{};
+    alignas(32) std::array<float, kBatchSize> scores{};
+
+    /**
+     * @brief Get the features of one lane
+     *
+     * @param lane The lane
+     * @return The features of the board in that lane
+     */
+    BoardFeatures lane(size_t lane) const;
+};
+
+/**
+ * @brief Compute the features of a single board
+ *
+ * @param board The board
+ * @param lines_cleared Lines cleared by the move which produced the board
+ * @return The features of the board
+ */
+BoardFeatures computeFeatures(const TetrisBoard &board, int lines_cleared);
+
+/**
+ * @brief Compute the weighted score of a set of features
+ *
+ * @param features The features
+ * @param weights The weights
+ * @return The score
+ */
+float scoreFeatures(const BoardFeatures &features, const FeatureWeights &weights);
+
+/**
+ * @brief Compute the features and scores of every board in a batch, using AVX2 when the CPU supports it
+ *
+ * @param batch The boards
+ * @param weights The feature weights
+ * @param out The features and scores
+ */
+void evaluateBatch(const BoardBatch &batch, const FeatureWeights &weights, FeatureBatch &out);
+
+/**
+ * @brief Portable implementation of evaluateBatch
+ *
+ */
+void evaluateBatchScalar(const BoardBatch &batch, const FeatureWeights &weights, FeatureBatch &out);
+
+/**
+ * @brief AVX2 implementation of evaluateBatch. Must only be called when avx2Supported() is true.
+ *
+ */
+void evaluateBatchAvx2(const BoardBatch &batch, const FeatureWeights &weights, FeatureBatch &out);
+
+/**
+ * @brief Determine whether the running CPU supports the AVX2 implementation
+ *
+ * @return true If evaluateBatchAvx2 may be called
+ * @return false Otherwise
+ */
+bool avx2Supported();
+
+#endif // TETRIS_EVALUATION_H
@@ -3,25 +3,262 @@
 
 #include <vector>
 #include <iostream>
-#include <map>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <compare>
 #include <functional>
+#include <stdexcept>
+#include <utility>
+#include "stats.h"
+
+/**
+ * @brief Maximum width and height of a piece. Pieces are stored as an 8x8 bitmask in a single 64 bit word.
+ *
+ */
+constexpr size_t kMaxPieceSize = 8;
+
+/**
+ * @brief Number of orientations a piece can take (4 rotations of the piece and 4 rotations of its horizontal mirror image).
+ * Orientation index o is reached by flipping the base piece horizontally if (o & 4), then rotating it clockwise (o & 3) times.
+ *
+ */
+constexpr size_t kOrientationCount = 8;
+
+/**
+ * @brief Skirt value of a column which contains no blocks
+ *
+ */
+constexpr uint8_t kNoBlock = 0xFF;
+
+/**
+ * @brief Mask of column zero of a piece bitmask. Shift left by c for column c.
+ *
+ */
+constexpr uint64_t kPieceColumnMask = 0x0101010101010101ULL;
+
+/**
+ * @brief Mirror every row of a piece bitmask, so column c moves to column kMaxPieceSize - 1 - c
+ *
+ * @param cells The bitmask to mirror
+ * @return The mirrored bitmask
+ */
+constexpr uint64_t mirrorPieceRows(uint64_t cells)
+{
+    cells = ((cells >> 1) & 0x5555555555555555ULL) | ((cells & 0x5555555555555555ULL) << 1);
+    cells = ((cells >> 2) & 0x3333333333333333ULL) | ((cells & 0x3333333333333333ULL) << 2);
+    cells = ((cells >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((cells & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    return cells;
+}
+
+/**
+ * @brief Mirror a piece bitmask top to bottom, so row r moves to row kMaxPieceSize - 1 - r
+ *
+ * @param cells The bitmask to mirror
+ * @return The mirrored bitmask
+ */
+constexpr uint64_t mirrorPieceColumns(uint64_t cells)
+{
+    return std::byteswap(cells);
+}
+
+/**
+ * @brief Transpose a piece bitmask, so cell (col, row) moves to (row, col)
+ *
+ * @param cells The bitmask to transpose
+ * @return The transposed bitmask
+ */
+constexpr uint64_t transposePiece(uint64_t cells)
+{
+    uint64_t t = 0x0F0F0F0F00000000ULL & (cells ^ (cells << 28));
+    cells ^= t ^ (t >> 28);
+    t = 0x3333000033330000ULL & (cells ^ (cells << 14));
+    cells ^= t ^ (t >> 14);
+    t = 0x5500550055005500ULL & (cells ^ (cells << 7));
+    cells ^= t ^ (t >> 7);
+    return cells;
+}
+
+/**
+ * @brief Scramble a 64 bit value (the SplitMix64 finalizer). Used to derive Zobrist keys and to mix small values into hashes.
+ *
+ * @param value The value to scramble
+ * @return The scrambled value
+ */
+constexpr uint64_t mixBits(uint64_t value)
+{
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+/**
+ * @brief The cells and dimensions of a piece, without its profile or orientation table. Ordered by cells, then width, then height.
+ *
+ */
+struct PieceShape
+{
+    uint64_t cells;
+    uint8_t width;
+    uint8_t height;
+
+    constexpr auto operator<=>(const PieceShape &) const = default;
+
+    /**
+     * @brief Hash the shape. Equal shapes always have equal hashes.
+     *
+     * @return The hash
+     */
+    constexpr uint64_t hash() const
+    {
+        return mixBits(cells ^ mixBits((uint64_t{width} << 8) | height));
+    }
+};
+
+/**
+ * @brief Move a shape into the given orientation (see kOrientationCount), relative to the shape itself
+ *
+ * @param shape The shape to move
+ * @param orientation The orientation index
+ * @return The shape in that orientation, packed against row and column zero
+ */
+constexpr PieceShape orientShape(PieceShape shape, uint8_t orientation)
+{
+    // Flip the shape if needed, then turn it clockwise. A clockwise turn is a transpose followed by a vertical flip.
+    if (orientation & 4)
+    {
+        shape.cells = mirrorPieceRows(shape.cells) >> (kMaxPieceSize - shape.width);
+    }
+    for (uint8_t turn = 0; turn < (orientation & 3); turn++)
+    {
+        shape.cells = transposePiece(shape.cells);
+        std::swap(shape.width, shape.height);
+        shape.cells = mirrorPieceColumns(shape.cells) >> ((kMaxPieceSize - shape.height) * kMaxPieceSize);
+    }
+    return shape;
+}
+
+/**
+ * @brief Group of transformations under which two pieces are considered the same, for canonical hashing and deduplication
+ *
+ */
+enum class PieceSymmetry : uint8_t
+{
+    // Pieces are only the same as identical pieces
+    None,
+    // Pieces are the same as their rotations
+    Rotations,
+    // Pieces are the same as their rotations and mirror images
+    RotationsAndReflections
+};
+
+struct PieceOrientationTable;
+class PieceFactoryTable;
 
 class TetrisPiece
 {
 
 public:
-    size_t width;
-    size_t height;
-    std::vector<std::vector<bool> *> *grid;
+    /**
+     * @brief Row-major bitmask of the piece. Bit (row * kMaxPieceSize + col) is set if that cell is filled. Row zero is the bottom of the piece.
+     *
+     */
+    uint64_t cells;
+    uint8_t width;
+    uint8_t height;
+
+    /**
+     * @brief Current orientation of the piece relative to the shape it was created from (see kOrientationCount)
+     *
+     */
+    uint8_t orientation;
+
+    /**
+     * @brief Precomputed orientations of this piece, or nullptr if the piece has none. When present, every rotation and flip is a table lookup.
+     *
+     */
+    const PieceOrientationTable *orientations;
+
+    /**
+     * @brief Row of the lowest block in each column, or kNoBlock for empty columns and columns beyond the width of the piece
+     *
+     */
+    std::array<uint8_t, kMaxPieceSize> skirt;
+
+    /**
+     * @brief One past the row of the highest block in each column, or zero for empty columns and columns beyond the width of the piece
+     *
+     */
+    std::array<uint8_t, kMaxPieceSize> top;
+
     /**
      * @brief Construct a new Tetris Piece from a 2D shape vector
      *
      * @param shape A column-major 2D vector of bools, where true indicates that part of the piece is present at that part of the grid.
      *
-     * @throws std:invalid_argument if width or height is zero, or if height is non-uniform
+     * @throws std:invalid_argument if width or height is zero, if height is non-uniform, or if either dimension exceeds kMaxPieceSize
      */
     TetrisPiece(std::vector<std::vector<bool>> shape);
-    ~TetrisPiece();
+
+    /**
+     * @brief Construct a new Tetris Piece from a bitmask. Usable in constant expressions.
+     *
+     * @param cells Row-major bitmask of the piece (see cells)
+     * @param width Width of the piece
+     * @param height Height of the piece
+     *
+     * @throws std::invalid_argument if either dimension is zero or exceeds kMaxPieceSize, or cells has bits outside the width and height
+     */
+    constexpr TetrisPiece(uint64_t cells, uint8_t width, uint8_t height)
+        : cells(cells), width(width), height(height), orientation(0), orientations(nullptr), skirt{}, top{}
+    {
+        if (width == 0 || height == 0 || width > kMaxPieceSize || height > kMaxPieceSize)
+        {
+            throw std::invalid_argument("Tetris piece dimensions must be between one and kMaxPieceSize");
+        }
+        uint64_t row_mask = (uint64_t{1} << width) - 1;
+        uint64_t box = 0;
+        for (size_t row_idx = 0; row_idx < height; row_idx++)
+        {
+            box |= row_mask << (row_idx * kMaxPieceSize);
+        }
+        if (cells & ~box)
+        {
+            throw std::invalid_argument("Tetris piece has cells outside its width and height");
+        }
+        computeProfile();
+        if !consteval
+        {
+            countStat(StatCounter::PieceConstructions);
+        }
+    }
+
+    /**
+     * @brief Determine whether the cell at the given position is filled. No bounds checking is performed.
+     *
+     * @param col_idx The column of the cell
+     * @param row_idx The row of the cell (zero is the bottom of the piece)
+     * @return true If the cell is part of the piece
+     * @return false If the cell is empty
+     */
+    bool at(size_t col_idx, size_t row_idx) const
+    {
+        return (cells >> (row_idx * kMaxPieceSize + col_idx)) & 1;
+    }
+
+    /**
+     * @brief Get the given row of the piece as a bitmask, with bit i set if column i is filled. No bounds checking is performed.
+     *
+     * @param row_idx The row to extract (zero is the bottom of the piece)
+     * @return The row bitmask
+     */
+    uint8_t row(size_t row_idx) const
+    {
+        return static_cast<uint8_t>(cells >> (row_idx * kMaxPieceSize));
+    }
 
     /**
      * @brief Compare two pieces
@@ -30,7 +267,50 @@ public:
      * @return true If the two pieces represent identical pieces
      * @return false If the two pieces do not represent identical pieces
      */
-    bool operator==(const TetrisPiece &p) const;
+    constexpr bool operator==(const TetrisPiece &p) const
+    {
+        return cells == p.cells && width == p.width && height == p.height;
+    }
+
+    /**
+     * @brief Get the cells and dimensions of the piece
+     *
+     * @return The shape of the piece
+     */
+    constexpr PieceShape shape() const
+    {
+        return PieceShape{cells, width, height};
+    }
+
+    /**
+     * @brief Get the representative of the piece under a symmetry group: the smallest shape among the orientations the group reaches.
+     * Pieces related by the group have the same canonical shape. Table-backed pieces read their orientations from the table.
+     *
+     * @param symmetry The symmetry group
+     * @return The canonical shape
+     */
+    constexpr PieceShape canonicalShape(PieceSymmetry symmetry) const;
+
+    /**
+     * @brief Hash the canonical shape of the piece, so pieces related by the symmetry group hash equally
+     *
+     * @param symmetry The symmetry group
+     * @return The hash
+     */
+    constexpr uint64_t canonicalHash(PieceSymmetry symmetry) const
+    {
+        return canonicalShape(symmetry).hash();
+    }
+
+    /**
+     * @brief Determine whether two pieces are related by a symmetry group
+     *
+     * @param p The piece to compare against
+     * @param symmetry The symmetry group
+     * @return true If some transformation in the group turns this piece into p
+     * @return false Otherwise
+     */
+    constexpr bool equivalent(const TetrisPiece &p, PieceSymmetry symmetry) const;
 
     /**
      * @brief Flip the piece horizontally (reorder columns)
@@ -62,11 +342,22 @@ public:
      */
     void rotate180();
 
+    /**
+     * @brief Put the piece into the given orientation (see kOrientationCount), relative to the shape it was created from
+     *
+     * @param target The orientation index to move to
+     *
+     * @throws std::out_of_range if target is not a valid orientation index
+     */
+    void setOrientation(uint8_t target);
+
     /**
      * @brief Determine the height of the lowest block in the given column
      *
      * @param col_idx The index of the column to find the lowest block in
      * @return The height of the lowest block in the given column (zero indexed). If no blocks are present in the given column the max size_t is returned.
+     *
+     * @throws std::out_of_range if col_idx is not a valid column
      */
     size_t lowestBlockInColumn(size_t col_idx) const;
 
@@ -88,7 +379,7 @@ public:
      *
      * @return A "Q" piece
      */
-    static TetrisPiece createQPiece();
+    static constexpr TetrisPiece createQPiece();
 
     /**
      * @brief Create and return a "Z" piece which looks like:
@@ -99,7 +390,7 @@ public:
      *
      * @return A "Z" piece
      */
-    static TetrisPiece createZPiece();
+    static constexpr TetrisPiece createZPiece();
 
     /**
      * @brief Create and return a "T" piece which looks like:
@@ -110,7 +401,7 @@ public:
      *
      * @return A "T" piece
      */
-    static TetrisPiece createTPiece();
+    static constexpr TetrisPiece createTPiece();
 
     /**
      * @brief Create and return an "I" piece which looks like:
@@ -119,7 +410,7 @@ public:
      *
      * @return An "I" piece
      */
-    static TetrisPiece createIPiece();
+    static constexpr TetrisPiece createIPiece();
 
     /**
      * @brief Create and return an "L" piece which looks like:
@@ -132,13 +423,365 @@ public:
      *
      * @return An "L" piece
      */
-    static TetrisPiece createLPiece();
+    static constexpr TetrisPiece createLPiece();
 
     /**
-     * @brief Map from piece names to factory functions for those pieces
+     * @brief Factory functions of the standard pieces, indexed by PieceId and by name
      *
      */
-    const static std::map<char, std::function<TetrisPiece()>> pieceFactories;
+    static const PieceFactoryTable pieceFactories;
+
+private:
+    // Recompute skirt and top from cells
+    constexpr void computeProfile()
+    {
+        for (size_t col_idx = 0; col_idx < kMaxPieceSize; col_idx++)
+        {
+            uint64_t column = col_idx < width ? (cells >> col_idx) & kPieceColumnMask : 0;
+            if (column == 0)
+            {
+                skirt[col_idx] = kNoBlock;
+                top[col_idx] = 0;
+                continue;
+            }
+            skirt[col_idx] = static_cast<uint8_t>(std::countr_zero(column) / kMaxPieceSize);
+            top[col_idx] = static_cast<uint8_t>((63 - std::countl_zero(column)) / kMaxPieceSize + 1);
+        }
+    }
+};
+
+/**
+ * @brief Every orientation of a piece, computed once, at compile time for the standard pieces. Pieces handed out by the table point back
+ * at it, so the table must outlive them and cannot be copied or moved.
+ *
+ */
+struct PieceOrientationTable
+{
+    /**
+     * @brief The piece in each orientation, indexed by orientation
+     *
+     */
+    std::array<TetrisPiece, kOrientationCount> pieces;
+
+    /**
+     * @brief For each orientation, the lowest orientation index with an identical shape
+     *
+     */
+    std::array<uint8_t, kOrientationCount> canonical;
+
+    /**
+     * @brief The first distinct_count entries are the orientations which are their own canonical orientation, in increasing order
+     *
+     */
+    std::array<uint8_t, kOrientationCount> distinct;
+    uint8_t distinct_count;
+
+    /**
+     * @brief Compute every orientation of the given piece
+     *
+     * @param base The piece in orientation zero
+     */
+    constexpr explicit PieceOrientationTable(const TetrisPiece &base)
+        : pieces{base, base, base, base, base, base, base, base}, canonical{}, distinct{}, distinct_count{0}
+    {
+        for (uint8_t orientation_idx = 0; orientation_idx < kOrientationCount; orientation_idx++)
+        {
+            PieceShape shape = orientShape(base.shape(), orientation_idx);
+            TetrisPiece piece{shape.cells, shape.width, shape.height};
+            piece.orientation = orientation_idx;
+            piece.orientations = this;
+            pieces[orientation_idx] = piece;
+
+            // Find the first orientation with the same shape
+            uint8_t first = 0;
+            while (!(pieces[first] == piece))
+            {
+                first++;
+            }
+            canonical[orientation_idx] = first;
+            if (first == orientation_idx)
+            {
+                distinct[distinct_count++] = orientation_idx;
+            }
+        }
+    }
+    PieceOrientationTable(const PieceOrientationTable &) = delete;
+    PieceOrientationTable &operator=(const PieceOrientationTable &) = delete;
+};
+
+constexpr PieceShape TetrisPiece::canonicalShape(PieceSymmetry symmetry) const
+{
+    PieceShape best = shape();
+    if (symmetry == PieceSymmetry::None)
+    {
+        return best;
+    }
+
+    // Rotations keep the flip bit of the orientation, so they are the four table entries sharing it
+    if (orientations != nullptr)
+    {
+        bool rotations_only = symmetry == PieceSymmetry::Rotations;
+        for (const TetrisPiece &oriented : orientations->pieces)
+        {
+            if (!rotations_only || (oriented.orientation & 4) == (orientation & 4))
+            {
+                best = std::min(best, oriented.shape());
+            }
+        }
+        return best;
+    }
+
+    uint8_t orientation_count = symmetry == PieceSymmetry::Rotations ? 4 : kOrientationCount;
+    for (uint8_t orientation_idx = 1; orientation_idx < orientation_count; orientation_idx++)
+    {
+        best = std::min(best, orientShape(shape(), orientation_idx));
+    }
+    return best;
+}
+
+constexpr bool TetrisPiece::equivalent(const TetrisPiece &p, PieceSymmetry symmetry) const
+{
+    if (std::popcount(cells) != std::popcount(p.cells))
+    {
+        return false;
+    }
+    if (*this == p)
+    {
+        return true;
+    }
+    // Every orientation in a table is a rotation or reflection of every other
+    if (symmetry == PieceSymmetry::RotationsAndReflections && orientations != nullptr && orientations == p.orientations)
+    {
+        return true;
+    }
+    return symmetry != PieceSymmetry::None && canonicalShape(symmetry) == p.canonicalShape(symmetry);
+}
+
+/**
+ * @brief Hash functor for unordered containers which treat pieces related by a symmetry group as the same key. Pair with
+ * PieceEquivalent of the same group.
+ *
+ */
+template <PieceSymmetry Symmetry>
+struct PieceHash
+{
+    size_t operator()(const TetrisPiece &piece) const
+    {
+        return piece.canonicalHash(Symmetry);
+    }
+};
+
+/**
+ * @brief Equality functor for unordered containers which treat pieces related by a symmetry group as the same key
+ *
+ */
+template <PieceSymmetry Symmetry>
+struct PieceEquivalent
+{
+    bool operator()(const TetrisPiece &a, const TetrisPiece &b) const
+    {
+        return a.equivalent(b, Symmetry);
+    }
+};
+
+/**
+ * @brief Hash pieces by exact shape, consistent with TetrisPiece::operator==
+ *
+ */
+template <>
+struct std::hash<TetrisPiece> : PieceHash<PieceSymmetry::None>
+{
+};
+
+template <>
+struct std::hash<PieceShape>
+{
+    size_t operator()(const PieceShape &shape) const
+    {
+        return shape.hash();
+    }
+};
+
+/**
+ * @brief Dense index of each standard piece, in name order. Usable directly as an array index.
+ *
+ */
+enum PieceId : uint8_t
+{
+    kPieceI,
+    kPieceL,
+    kPieceQ,
+    kPieceT,
+    kPieceZ,
+    kStandardPieceCount
 };
 
+/**
+ * @brief Orientation tables of the standard pieces, indexed by PieceId. Built entirely at compile time.
+ *
+ */
+inline constexpr std::array<PieceOrientationTable, kStandardPieceCount> kStandardPieces = {
+    PieceOrientationTable{TetrisPiece{0x000000000000000FULL, 4, 1}},
+    PieceOrientationTable{TetrisPiece{0x0000000000010103ULL, 2, 3}},
+    PieceOrientationTable{TetrisPiece{0x0000000000000303ULL, 2, 2}},
+    PieceOrientationTable{TetrisPiece{0x0000000000000702ULL, 3, 2}},
+    PieceOrientationTable{TetrisPiece{0x0000000000000306ULL, 3, 2}},
+};
+
+/**
+ * @brief Get a standard piece in its base orientation, as a constant expression
+ *
+ * @param id The piece to get
+ * @return The piece, which can be turned with a lookup into its orientation table. No bounds checking is performed.
+ */
+constexpr const TetrisPiece &standardPiece(PieceId id)
+{
+    return kStandardPieces[id].pieces[0];
+}
+
+constexpr TetrisPiece TetrisPiece::createQPiece()
+{
+    return standardPiece(kPieceQ);
+}
+
+constexpr TetrisPiece TetrisPiece::createZPiece()
+{
+    return standardPiece(kPieceZ);
+}
+
+constexpr TetrisPiece TetrisPiece::createTPiece()
+{
+    return standardPiece(kPieceT);
+}
+
+constexpr TetrisPiece TetrisPiece::createIPiece()
+{
+    return standardPiece(kPieceI);
+}
+
+constexpr TetrisPiece TetrisPiece::createLPiece()
+{
+    return standardPiece(kPieceL);
+}
+
+/**
+ * @brief Name of each standard piece, indexed by PieceId
+ *
+ */
+inline constexpr std::array<char, kStandardPieceCount> kPieceNames = {'I', 'L', 'Q', 'T', 'Z'};
+
+/**
+ * @brief Id of the standard piece with each name, indexed by character, or kStandardPieceCount for characters which name no piece
+ *
+ */
+inline constexpr std::array<uint8_t, 256> kPieceIdsByName = []
+{
+    std::array<uint8_t, 256> ids{};
+    ids.fill(kStandardPieceCount);
+    for (uint8_t id = 0; id < kStandardPieceCount; id++)
+    {
+        ids[static_cast<unsigned char>(kPieceNames[id])] = id;
+    }
+    return ids;
+}();
+
+/**
+ * @brief Parse a standard piece name
+ *
+ * @param name The name of the piece
+ * @return The id of the piece
+ *
+ * @throws std::out_of_range if name is not the name of a standard piece
+ */
+constexpr PieceId pieceIdFromName(char name)
+{
+    uint8_t id = kPieceIdsByName[static_cast<unsigned char>(name)];
+    if (id == kStandardPieceCount)
+    {
+        throw std::out_of_range("Unknown piece name");
+    }
+    return static_cast<PieceId>(id);
+}
+
+/**
+ * @brief Determine which standard piece a piece is, in O(1) from its orientation table
+ *
+ * @param piece Any orientation of any piece
+ * @return The id of the piece, or kStandardPieceCount if it is not a standard piece
+ */
+inline PieceId standardPieceId(const TetrisPiece &piece)
+{
+    for (uint8_t id = 0; id < kStandardPieceCount; id++)
+    {
+        if (piece.orientations == &kStandardPieces[id])
+        {
+            return static_cast<PieceId>(id);
+        }
+    }
+    return kStandardPieceCount;
+}
+
+/**
+ * @brief Flat table of the standard piece factories. Iterates as (name, factory) pairs in PieceId order, and looks pieces up by name
+ * with a single array index instead of a tree walk.
+ *
+ */
+class PieceFactoryTable
+{
+public:
+    using Factory = TetrisPiece (*)();
+    using value_type = std::pair<char, Factory>;
+
+private:
+    std::array<value_type, kStandardPieceCount> factories = {{
+        {'I', &TetrisPiece::createIPiece},
+        {'L', &TetrisPiece::createLPiece},
+        {'Q', &TetrisPiece::createQPiece},
+        {'T', &TetrisPiece::createTPiece},
+        {'Z', &TetrisPiece::createZPiece},
+    }};
+
+public:
+    /**
+     * @brief Get the factory of the piece with the given name
+     *
+     * @param name The name of the piece
+     * @return The factory
+     *
+     * @throws std::out_of_range if name is not the name of a standard piece
+     */
+    constexpr Factory at(char name) const
+    {
+        return factories[pieceIdFromName(name)].second;
+    }
+
+    /**
+     * @brief Get the name and factory of the piece with the given id. No bounds checking is performed.
+     *
+     * @param id The id of the piece
+     * @return The name and factory
+     */
+    constexpr const value_type &operator[](PieceId id) const
+    {
+        return factories[id];
+    }
+
+    constexpr size_t size() const
+    {
+        return factories.size();
+    }
+
+    constexpr const value_type *begin() const
+    {
+        return factories.data();
+    }
+
+    constexpr const value_type *end() const
+    {
+        return factories.data() + factories.size();
+    }
+};
+
+inline constexpr PieceFactoryTable TetrisPiece::pieceFactories{};
+
 #endif // TETRIS_PIECE_H
\ No newline at end of file
@@ -0,0 +1,137 @@
+#ifndef TETRIS_PIECE_SET_H
+#define TETRIS_PIECE_SET_H
+
+#include <cstddef>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include "piece.h"
+
+/**
+ * @brief A named set of pieces, each with a precomputed orientation table, so custom pieces run on the same table driven paths as the
+ * standard ones. Sets are either the standard set or loaded from a text file of pictures:
+ *
+ * # Comments start with a hash
+ *
+ * piece F
+ *
+ * _XX
+ *
+ * XX_
+ *
+ * _X_
+ *
+ * Each piece starts with "piece" and a single character name, followed by its rows from top to bottom, with X for a filled cell and
+ * _ or . for an empty one. Blank lines between pieces are ignored.
+ *
+ */
+class PieceSet
+{
+    std::vector<char> names;
+    std::vector<const PieceOrientationTable *> tables;
+    // Tables of loaded pieces. The standard set points at kStandardPieces instead.
+    std::vector<std::unique_ptr<PieceOrientationTable>> owned_tables;
+
+public:
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    /**
+     * @brief Create an empty set
+     *
+     */
+    PieceSet() = default;
+
+    /**
+     * @brief Get the standard set, whose indices match PieceId
+     *
+     * @return The standard set
+     */
+    static const PieceSet &standard();
+
+    /**
+     * @brief Parse a piece set
+     *
+     * @param in Stream holding the set in the format described above
+     * @return The set, with pieces in the order they appear
+     *
+     * @throws std::invalid_argument if the stream is malformed or any piece fails validation (see add)
+     */
+    static PieceSet parse(std::istream &in);
+
+    /**
+     * @brief Load a piece set from a file
+     *
+     * @param path Path of the file
+     * @return The set, with pieces in the order they appear
+     *
+     * @throws std::runtime_error if the file cannot be opened
+     * @throws std::invalid_argument if the file is malformed or any piece fails validation (see add)
+     */
+    static PieceSet load(const std::string &path);
+
+    /**
+     * @brief Validate a piece and add it to the set, computing its orientation table
+     *
+     * @param name Name of the piece
+     * @param shape The piece in its base orientation
+     * @return The index of the new piece
+     *
+     * @throws std::invalid_argument if the name is already used, the shape has an empty row or column on its border, its cells are not
+     * all connected through their edges, or it is a rotation or reflection of a piece already in the set
+     */
+    size_t add(char name, const TetrisPiece &shape);
+
+    /**
+     * @brief Get the number of pieces in the set
+     *
+     * @return The number of pieces
+     */
+    size_t size() const
+    {
+        return tables.size();
+    }
+
+    /**
+     * @brief Get a piece in its base orientation. No bounds checking is performed.
+     *
+     * @param piece_idx Index of the piece
+     * @return The piece, which can be turned with lookups into its orientation table
+     */
+    const TetrisPiece &piece(size_t piece_idx) const
+    {
+        return tables[piece_idx]->pieces[0];
+    }
+
+    /**
+     * @brief Get the name of a piece. No bounds checking is performed.
+     *
+     * @param piece_idx Index of the piece
+     * @return The name of the piece
+     */
+    char name(size_t piece_idx) const
+    {
+        return names[piece_idx];
+    }
+
+    /**
+     * @brief Find a piece by name
+     *
+     * @param name The name of the piece
+     * @return The index of the piece
+     *
+     * @throws std::out_of_range if no piece has that name
+     */
+    size_t indexOf(char name) const;
+
+    /**
+     * @brief Find the piece an oriented piece was dealt from, by its orientation table
+     *
+     * @param piece Any orientation of any piece
+     * @return The index of the piece, or npos if it does not belong to the set
+     */
+    size_t indexOf(const TetrisPiece &piece) const;
+};
+
+#endif // TETRIS_PIECE_SET_H
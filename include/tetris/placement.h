@@ -0,0 +1,45 @@
+#ifndef TETRIS_PLACEMENT_H
+#define TETRIS_PLACEMENT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include "board.h"
+#include "piece.h"
+
+/**
+ * @brief A final resting position of a piece on a board
+ *
+ */
+struct Placement
+{
+    // Orientation index of the piece (see kOrientationCount)
+    uint8_t orientation;
+    // Board column of the left edge of the piece
+    uint8_t column;
+    // Board row the bottom of the piece lands in
+    uint8_t row;
+
+    bool operator==(const Placement &p) const = default;
+};
+
+/**
+ * @brief Upper bound on the number of placements of a single piece, and the minimum buffer size for enumeratePlacements
+ *
+ */
+constexpr size_t kMaxPlacements = kOrientationCount * TetrisBoard::width;
+
+/**
+ * @brief Enumerate every distinct hard-drop placement of a piece on a board. Orientations which produce the same shape are only reported once,
+ * using the lowest orientation index. Placements which would leave part of the piece above the top of the board are skipped. Does not allocate.
+ *
+ * @param board The board to place the piece on
+ * @param piece The piece to place, in any orientation
+ * @param out Buffer to write the placements to, in order of orientation then column
+ * @return The number of placements written to out
+ *
+ * @throws std::invalid_argument if out holds fewer than kMaxPlacements entries
+ */
+size_t enumeratePlacements(const TetrisBoard &board, const TetrisPiece &piece, std::span<Placement> out);
+
+#endif // TETRIS_PLACEMENT_H
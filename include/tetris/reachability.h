@@ -0,0 +1,178 @@
+#ifndef TETRIS_REACHABILITY_H
+#define TETRIS_REACHABILITY_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "board.h"
+#include "piece.h"
+#include "placement.h"
+
+/**
+ * @brief A single player input while a piece is falling
+ *
+ */
+enum class Input : uint8_t
+{
+    Left,
+    Right,
+    RotateClockwise,
+    RotateCounterClockwise,
+    // Move down one row
+    SoftDrop,
+    // Drop to the resting row and lock
+    HardDrop
+};
+
+/**
+ * @brief Kind of spin a placement was locked with
+ *
+ */
+enum class SpinType : uint8_t
+{
+    None,
+    // A T piece rotated into place with three corners around its centre filled, but only one of the two in front of its point
+    Mini,
+    // A T piece rotated into place with three corners around its centre filled, including both in front of its point
+    Full
+};
+
+/**
+ * @brief Offset tried when a rotation collides, in columns to the right and rows up
+ *
+ */
+struct Kick
+{
+    int8_t columns;
+    int8_t rows;
+};
+
+/**
+ * @brief Kicks tried in order after a rotation. Pieces here are placed by the bottom left corner of their bounding box rather than a
+ * rotation centre, so rotations first keep the centre of the box in place and then try these offsets.
+ *
+ */
+constexpr std::array<Kick, 9> kDefaultKicks = {
+    Kick{0, 0}, Kick{-1, 0}, Kick{1, 0}, Kick{0, -1}, Kick{-1, -1}, Kick{1, -1}, Kick{0, 1}, Kick{-2, 0}, Kick{2, 0}};
+
+/**
+ * @brief A resting placement reachable from the spawn position
+ *
+ */
+struct ReachablePlacement
+{
+    Placement placement;
+    SpinType spin;
+    // Length of the shortest input sequence reaching the placement, including the final hard drop
+    uint16_t input_count;
+    // State the hard drop starts from, used to rebuild the inputs
+    uint16_t origin;
+};
+
+/**
+ * @brief Finds every placement a piece can reach from its spawn position by shifting, rotating with kicks and soft dropping, including
+ * placements tucked under overhangs that a straight drop misses. The search is a breadth first search over (rotation, column, row)
+ * states, so every placement comes with a shortest input sequence. All state lives in fixed arrays inside the object and collision
+ * tests are precomputed as one bitmask of free columns per rotation and row, so a search performs no allocation. Reuse one object per
+ * thread; it is too large to create per move.
+ *
+ */
+class ReachabilitySearch
+{
+public:
+    // Only rotations are inputs, so a piece keeps the mirror bit of its spawn orientation
+    static constexpr int kRotations = 4;
+    static constexpr size_t kMaxStates = kRotations * TetrisBoard::width * TetrisBoard::height;
+
+    /**
+     * @brief Most placements a search can report. A placement may be listed twice, once locked with a spin and once without, when it
+     * can be reached both by rotating into it and by shifting or dropping into it.
+     *
+     */
+    static constexpr size_t kMaxReachable = 2 * kMaxStates;
+
+private:
+    using Row = TetrisBoard::Row;
+
+    std::span<const Kick> kicks;
+
+    // The piece in each rotation, its orientation index, and the first rotation with the same shape
+    std::array<PieceShape, kRotations> rotations;
+    std::array<uint8_t, kRotations> orientations;
+    std::array<uint8_t, kRotations> canonical;
+    // Whether the piece is a T, the only piece that can spin
+    bool can_spin;
+
+    // Bit x of open[r][y] is set if rotation r fits with its bottom left corner at (x, y)
+    std::array<std::array<Row, TetrisBoard::height>, kRotations> open;
+    // The same, transposed: bit y of open_rows[r][x] is set if rotation r fits at (x, y). Used to find where a hard drop stops.
+    std::array<std::array<TetrisBoard::RowMask, TetrisBoard::width>, kRotations> open_rows;
+    // A state can be arrived at by a shift or soft drop, after which it locks without a spin, or by a rotation, after which it may
+    // lock with one. The first arrival of each kind is kept, so a placement reachable both ways is reported both ways.
+    static constexpr int kMoved = 0;
+    static constexpr int kRotated = 1;
+    std::array<std::array<std::array<Row, TetrisBoard::height>, kRotations>, 2> arrived;
+    // Placements already reported, by spin type
+    std::array<std::array<std::array<Row, TetrisBoard::height>, kRotations>, 3> reported;
+
+    // Breadth first queue; for each kind of arrival at each state, the state and input it came from and its distance from the spawn;
+    // and the kind of each state's first, and so shortest, arrival
+    std::array<uint16_t, kMaxStates> queue;
+    std::array<std::array<uint16_t, kMaxStates>, 2> parent;
+    std::array<std::array<Input, kMaxStates>, 2> parent_input;
+    std::array<std::array<uint16_t, kMaxStates>, 2> distance;
+    std::array<uint8_t, kMaxStates> first_arrival;
+    uint16_t spawn_state;
+
+    static constexpr uint16_t stateId(int rotation, int column, int row)
+    {
+        return static_cast<uint16_t>((rotation * TetrisBoard::height + row) * TetrisBoard::width + column);
+    }
+
+    bool fits(int rotation, int column, int row) const
+    {
+        return column >= 0 && row >= 0 && row < TetrisBoard::height && ((open[rotation][row] >> column) & 1);
+    }
+
+    // Work out the rotations of the piece and which positions each one fits in
+    void prepare(const TetrisBoard &board, const TetrisPiece &piece);
+
+    // Classify a placement locked straight after a rotation
+    SpinType spinType(const TetrisBoard &board, int rotation, int column, int row) const;
+
+public:
+    /**
+     * @brief Create a search
+     *
+     * @param kicks Offsets tried in order after each rotation, which must outlive the search. An empty list disables rotation.
+     */
+    explicit ReachabilitySearch(std::span<const Kick> kicks = kDefaultKicks);
+
+    /**
+     * @brief Find every placement reachable from the spawn position: the piece in its current orientation, centred horizontally with its
+     * top against the top of the board. Placements are reported in order of their shortest input sequence, and shapes which look the
+     * same in several rotations are reported once, under the first such rotation.
+     *
+     * @param board The board
+     * @param piece The piece to place
+     * @param out Buffer for the placements
+     * @return The number of placements written, which is zero if the piece does not fit at the spawn position
+     *
+     * @throws std::invalid_argument if out holds fewer than kMaxReachable entries
+     */
+    size_t search(const TetrisBoard &board, const TetrisPiece &piece, std::span<ReachablePlacement> out);
+
+    /**
+     * @brief Rebuild the shortest input sequence of a placement from the most recent search
+     *
+     * @param placement A placement reported by the most recent search
+     * @param out Buffer for the inputs, ending with the hard drop
+     * @return The number of inputs written
+     *
+     * @throws std::invalid_argument if out holds fewer than placement.input_count entries
+     */
+    size_t inputs(const ReachablePlacement &placement, std::span<Input> out) const;
+};
+
+#endif // TETRIS_REACHABILITY_H
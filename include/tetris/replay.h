@@ -0,0 +1,236 @@
+#ifndef TETRIS_REPLAY_H
+#define TETRIS_REPLAY_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "board.h"
+#include "piece.h"
+#include "placement.h"
+
+/**
+ * @brief A recorded move: which piece was dealt, and where it was placed
+ *
+ */
+struct ReplayMove
+{
+    // The piece that was dealt
+    PieceId piece;
+    // Canonical orientation the piece was placed in
+    uint8_t orientation;
+    // Board column of the left edge of the piece
+    uint8_t column;
+
+    bool operator==(const ReplayMove &m) const = default;
+};
+
+/**
+ * @brief Maps every (piece, distinct orientation, column) triple of the standard piece set to a dense move code. With the standard
+ * pieces on a 10 wide board there are fewer than 256 codes, so a move, including the piece that was dealt, is a single byte.
+ *
+ */
+class ReplayCodec
+{
+    std::vector<ReplayMove> moves;
+    // Code of column zero for each (piece, orientation), or kNoCode for non-canonical orientations
+    std::array<uint16_t, kStandardPieceCount * kOrientationCount> first_codes;
+
+public:
+    static constexpr uint16_t kNoCode = 0xFFFF;
+
+    ReplayCodec();
+
+    /**
+     * @brief Get the number of distinct move codes
+     *
+     * @return The number of codes
+     */
+    size_t codeCount() const
+    {
+        return moves.size();
+    }
+
+    /**
+     * @brief Get the number of bytes used to store each move
+     *
+     * @return 1 if every code fits in a byte, otherwise 2
+     */
+    size_t codeSize() const
+    {
+        return moves.size() <= 256 ? 1 : 2;
+    }
+
+    /**
+     * @brief Identify the piece set and board size the codes were built for, so readers can reject replays they would misread
+     *
+     * @return A hash of the piece shapes and board width
+     */
+    uint64_t fingerprint() const;
+
+    /**
+     * @brief Encode a move
+     *
+     * @param move The move. Any orientation is accepted and stored as its canonical equivalent.
+     * @return The move code
+     *
+     * @throws std::invalid_argument if the move is not valid on the board
+     */
+    uint16_t encode(const ReplayMove &move) const;
+
+    /**
+     * @brief Decode a move
+     *
+     * @param code The move code
+     * @return The move
+     *
+     * @throws std::invalid_argument if code is not a valid move code
+     */
+    const ReplayMove &decode(uint16_t code) const;
+};
+
+/**
+ * @brief Writes a replay to a stream as it is played. Moves are grouped into blocks; each block begins with a snapshot of the board,
+ * and an index of the blocks is written when the replay is finished. Only the index stays in memory.
+ *
+ */
+class ReplayWriter
+{
+    std::ostream &out;
+    ReplayCodec codec;
+    uint32_t block_size;
+    TetrisBoard board;
+    uint64_t move_count;
+    uint64_t bytes_written;
+    // File offset of each block
+    std::vector<uint64_t> block_offsets;
+    bool finished;
+
+    void writeBytes(const void *bytes, size_t count);
+
+public:
+    /**
+     * @brief Start a replay, writing the header to out
+     *
+     * @param out Stream to write to, opened in binary mode. Must outlive the writer.
+     * @param block_size Number of moves between board snapshots
+     *
+     * @throws std::invalid_argument if block_size is zero
+     */
+    explicit ReplayWriter(std::ostream &out, uint32_t block_size = 4096);
+
+    /**
+     * @brief Finishes the replay if finish has not been called
+     *
+     */
+    ~ReplayWriter();
+
+    /**
+     * @brief Record a move and apply it to the writer's copy of the board
+     *
+     * @param piece The piece that was dealt
+     * @param placement Where it was placed
+     * @return The number of lines the move cleared
+     *
+     * @throws std::invalid_argument if the piece is not a standard piece or the placement is not valid
+     * @throws std::overflow_error if the placement lands above the top of the board. Nothing is written and the board is left unchanged,
+     * so the moves recorded before it can still be finished and read back.
+     * @throws std::logic_error if finish has already been called
+     */
+    int record(const TetrisPiece &piece, const Placement &placement);
+
+    /**
+     * @brief Write the block index and footer. No moves may be recorded afterwards.
+     *
+     */
+    void finish();
+
+    /**
+     * @brief Get the board after every recorded move
+     *
+     * @return The current board
+     */
+    const TetrisBoard &currentBoard() const
+    {
+        return board;
+    }
+};
+
+/**
+ * @brief Reads a replay file through a read-only memory mapping. Any move can be reached by replaying from the snapshot at the start
+ * of its block.
+ *
+ */
+class ReplayReader
+{
+    ReplayCodec codec;
+    const uint8_t *data;
+    size_t size;
+    uint32_t block_size;
+    uint64_t move_count;
+    uint64_t index_offset;
+    uint64_t block_count;
+
+    // Bounds-checked access to the mapping
+    const uint8_t *at(uint64_t offset, uint64_t count) const;
+
+    // Offset of the first move code of a block
+    uint64_t blockMovesOffset(uint64_t block_idx) const;
+
+public:
+    /**
+     * @brief Map a replay file
+     *
+     * @param path Path of the file
+     *
+     * @throws std::runtime_error if the file cannot be mapped or is not a valid replay for this piece set
+     */
+    explicit ReplayReader(const std::string &path);
+    ~ReplayReader();
+    ReplayReader(const ReplayReader &) = delete;
+    ReplayReader &operator=(const ReplayReader &) = delete;
+
+    /**
+     * @brief Get the number of recorded moves
+     *
+     * @return The number of moves
+     */
+    uint64_t moveCount() const
+    {
+        return move_count;
+    }
+
+    /**
+     * @brief Decode a move
+     *
+     * @param move_idx Index of the move
+     * @return The move
+     *
+     * @throws std::out_of_range if move_idx is not less than moveCount()
+     */
+    ReplayMove move(uint64_t move_idx) const;
+
+    /**
+     * @brief Get the piece dealt for a move, in the orientation it was placed in
+     *
+     * @param move_idx Index of the move
+     * @return The placed piece
+     *
+     * @throws std::out_of_range if move_idx is not less than moveCount()
+     */
+    TetrisPiece piece(uint64_t move_idx) const;
+
+    /**
+     * @brief Reconstruct the board just before a move, starting from the nearest snapshot
+     *
+     * @param move_idx Index of the move. moveCount() gives the final board.
+     * @return The board
+     *
+     * @throws std::out_of_range if move_idx is greater than moveCount()
+     */
+    TetrisBoard boardBefore(uint64_t move_idx) const;
+};
+
+#endif // TETRIS_REPLAY_H
@@ -0,0 +1,87 @@
+#ifndef TETRIS_SEARCH_H
+#define TETRIS_SEARCH_H
+
+#include <functional>
+#include <span>
+#include "board.h"
+#include "piece.h"
+#include "placement.h"
+#include "thread_pool.h"
+#include "transposition_table.h"
+
+/**
+ * @brief Scores a leaf board of the search. Higher is better.
+ *
+ * @param board The board after every piece of the sequence has been placed
+ * @param lines_cleared Total number of lines cleared along the path to the board
+ */
+using EvaluationFunction = std::function<double(const TetrisBoard &board, int lines_cleared)>;
+
+/**
+ * @brief The outcome of a search
+ *
+ */
+struct SearchResult
+{
+    // Placement of the first piece of the sequence on the best path
+    Placement placement;
+    // Score of the best leaf reachable through placement
+    double score;
+    // False if the first piece had no legal placement
+    bool found;
+};
+
+/**
+ * @brief Exhaustive lookahead search over a known piece sequence. Every placement of every piece is tried, and the first placement
+ * leading to the best scoring leaf is returned. The top plies of the tree are split into tasks on a work-stealing thread pool; below
+ * that each task searches its subtree alone, on its own board copies. When given a transposition table, subtrees reached again through
+ * a different move order are looked up instead of searched.
+ *
+ */
+class GameTreeSearch
+{
+    EvaluationFunction evaluate;
+    ThreadPool &pool;
+    int parallel_plies;
+    TranspositionTable *table;
+
+    // Search a subtree on the calling thread, returning the best leaf score. Moves are made and unmade on the board, which is left as it was found.
+    double searchSequential(TetrisBoard &board, std::span<const TetrisPiece> pieces, int lines_cleared) const;
+
+    // Search a subtree, splitting its top plies into pool tasks, and report the best placement of pieces[0]
+    SearchResult searchParallel(const TetrisBoard &board, std::span<const TetrisPiece> pieces, int lines_cleared, int plies_to_split) const;
+
+public:
+    /**
+     * @brief Create a search
+     *
+     * @param evaluate Leaf evaluation function, which must be safe to call from several threads at once
+     * @param pool Pool to run subtrees on
+     * @param parallel_plies Number of plies at the top of the tree whose children are run as separate tasks
+     * @param table Optional transposition table shared by every thread of the search. Must outlive the search.
+     */
+    GameTreeSearch(EvaluationFunction evaluate, ThreadPool &pool, int parallel_plies = 2, TranspositionTable *table = nullptr);
+
+    /**
+     * @brief Find the best placement of the first piece of a sequence
+     *
+     * @param board The starting board
+     * @param pieces The pieces to place, in order. The search looks pieces.size() plies ahead.
+     * @return The best placement of pieces[0]. Ties go to the placement enumerated first.
+     *
+     * @throws std::invalid_argument if pieces is empty
+     */
+    SearchResult search(const TetrisBoard &board, std::span<const TetrisPiece> pieces) const;
+
+    /**
+     * @brief Determine the transposition key of a search node
+     *
+     * @param board The board at the node
+     * @param pieces The pieces still to be placed, starting with the piece to move
+     * @param lines_cleared Lines cleared on the path to the node
+     * @return The key
+     */
+    static uint64_t nodeKey(const TetrisBoard &board, std::span<const TetrisPiece> pieces, int lines_cleared);
+};
+
+#endif // TETRIS_SEARCH_H
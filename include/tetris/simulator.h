@@ -0,0 +1,148 @@
+#ifndef TETRIS_SIMULATOR_H
+#define TETRIS_SIMULATOR_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+#include "board.h"
+#include "evaluation.h"
+#include "piece.h"
+#include "piece_set.h"
+#include "placement.h"
+#include "replay.h"
+
+/**
+ * @brief Seeded, reproducible source of pieces. Pieces are dealt in bags: every bag is a shuffle of one of each piece in a set, so the
+ * same seed and set always produce the same sequence.
+ *
+ */
+class PieceGenerator
+{
+    const PieceSet *pieces;
+    std::vector<uint8_t> bag;
+    size_t bag_position;
+    uint64_t rng_state;
+
+    // Next raw random number
+    uint64_t nextRandom();
+
+    // Refill and shuffle the bag
+    void shuffleBag();
+
+public:
+    /**
+     * @brief Create a generator
+     *
+     * @param seed Seed of the sequence
+     * @param pieces Set to deal from, which must outlive the generator
+     */
+    explicit PieceGenerator(uint64_t seed, const PieceSet &pieces = PieceSet::standard());
+
+    /**
+     * @brief Deal the next piece. Does not allocate.
+     *
+     * @return The next piece, in orientation zero
+     */
+    const TetrisPiece &next()
+    {
+        return pieces->piece(nextIndex());
+    }
+
+    /**
+     * @brief Deal the next piece as its index in the set (its PieceId for the standard set). Advances the same sequence as next.
+     *
+     * @return The index of the next piece
+     */
+    size_t nextIndex();
+};
+
+/**
+ * @brief Chooses where to place a piece. Returning std::nullopt ends the game.
+ *
+ * @param board The current board
+ * @param piece The piece to place
+ */
+using Policy = std::function<std::optional<Placement>(const TetrisBoard &board, const TetrisPiece &piece)>;
+
+/**
+ * @brief Create a policy which plays the placement with the best weighted feature score after one move
+ *
+ * @param weights Feature weights used to score each resulting board
+ * @return The policy
+ */
+Policy greedyPolicy(const FeatureWeights &weights);
+
+/**
+ * @brief Points awarded for clearing the given number of lines with one piece
+ *
+ */
+constexpr std::array<uint32_t, kMaxPieceSize + 1> kLineClearScores = {0, 100, 300, 500, 800, 1200, 1600, 2000, 2400};
+
+/**
+ * @brief Outcome of a single game
+ *
+ */
+struct GameResult
+{
+    uint64_t seed;
+    uint64_t pieces_placed;
+    uint64_t lines_cleared;
+    uint64_t score;
+    // Number of pieces which cleared exactly i lines
+    std::array<uint64_t, kMaxPieceSize + 1> clears_by_size;
+    // False if the game stopped at the piece limit rather than by topping out
+    bool topped_out;
+};
+
+/**
+ * @brief Play one complete game. Nothing inside the game loop allocates or performs I/O, apart from whatever the policy does.
+ *
+ * @param seed Seed of the piece sequence
+ * @param policy Policy choosing each placement
+ * @param max_pieces Stop after this many pieces even if the game is still alive
+ * @param replay If not null, every placed piece is also recorded to this writer. Only games of the standard set can be recorded.
+ * @param pieces Set the pieces are dealt from
+ * @return The outcome of the game
+ */
+GameResult playGame(uint64_t seed, const Policy &policy, uint64_t max_pieces, ReplayWriter *replay = nullptr,
+                    const PieceSet &pieces = PieceSet::standard());
+
+/**
+ * @brief Totals over a run of games
+ *
+ */
+struct SimulationSummary
+{
+    uint64_t games;
+    uint64_t pieces_placed;
+    uint64_t lines_cleared;
+    double seconds;
+
+    double gamesPerSecond() const
+    {
+        return seconds > 0 ? games / seconds : 0;
+    }
+
+    double piecesPerSecond() const
+    {
+        return seconds > 0 ? pieces_placed / seconds : 0;
+    }
+};
+
+/**
+ * @brief Play games with consecutive seeds on the calling thread and time them
+ *
+ * @param first_seed Seed of the first game. Game i uses first_seed + i.
+ * @param games Number of games to play
+ * @param policy Policy choosing each placement
+ * @param max_pieces Piece limit of each game
+ * @param pieces Set the pieces are dealt from
+ * @return Totals over every game
+ */
+SimulationSummary simulate(uint64_t first_seed, uint64_t games, const Policy &policy, uint64_t max_pieces,
+                           const PieceSet &pieces = PieceSet::standard());
+
+#endif // TETRIS_SIMULATOR_H
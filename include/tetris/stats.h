@@ -0,0 +1,201 @@
+#ifndef TETRIS_STATS_H
+#define TETRIS_STATS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @brief Whether engine instrumentation is compiled in. Build with -DTETRIS_STATS (make STATS=1) to enable it. When disabled every
+ * counter and timer below compiles to nothing.
+ *
+ */
+#ifdef TETRIS_STATS
+constexpr bool kStatsEnabled = true;
+#else
+constexpr bool kStatsEnabled = false;
+#endif
+
+/**
+ * @brief Events counted on the hot paths of the engine
+ *
+ */
+enum class StatCounter : uint8_t
+{
+    // Calls to addPiece
+    AddPiece,
+    // addPiece calls which cleared at least one line
+    LineClears,
+    // Total number of lines cleared
+    LinesCleared,
+    // Calls to collides
+    CollisionChecks,
+    // Rotations, flips and setOrientation calls on pieces
+    Rotations,
+    // Pieces constructed from a shape or bitmask, excluding copies
+    PieceConstructions,
+    Count
+};
+
+/**
+ * @brief Operations timed on the hot paths of the engine
+ *
+ */
+enum class StatTimer : uint8_t
+{
+    AddPiece,
+    LineClear,
+    Count
+};
+
+constexpr size_t kStatCounterCount = static_cast<size_t>(StatCounter::Count);
+constexpr size_t kStatTimerCount = static_cast<size_t>(StatTimer::Count);
+
+/**
+ * @brief Totals of every counter and timer at one point in time
+ *
+ */
+struct StatsSnapshot
+{
+    std::array<uint64_t, kStatCounterCount> counters{};
+    std::array<uint64_t, kStatTimerCount> timer_calls{};
+    std::array<uint64_t, kStatTimerCount> timer_nanoseconds{};
+
+    /**
+     * @brief Get the activity between two snapshots
+     *
+     * @param earlier A snapshot taken before this one
+     * @return The difference of every counter and timer
+     */
+    StatsSnapshot operator-(const StatsSnapshot &earlier) const;
+
+    uint64_t counter(StatCounter counter_id) const
+    {
+        return counters[static_cast<size_t>(counter_id)];
+    }
+};
+
+/**
+ * @brief The counters of one thread. Only the owning thread writes them, so increments are a plain load and store with no locked
+ * instruction, while collectStats may read them from any thread at any time. Blocks are never freed, so the counts of threads which have
+ * exited are still included in the totals.
+ *
+ */
+struct ThreadStats
+{
+    std::array<std::atomic<uint64_t>, kStatCounterCount> counters{};
+    std::array<std::atomic<uint64_t>, kStatTimerCount> timer_calls{};
+    std::array<std::atomic<uint64_t>, kStatTimerCount> timer_nanoseconds{};
+    ThreadStats *next{nullptr};
+};
+
+/**
+ * @brief Create the calling thread's counters and link them into the list read by collectStats
+ *
+ * @return The new counters
+ */
+ThreadStats &registerThreadStats();
+
+/**
+ * @brief The calling thread's counters, or nullptr until it first records something
+ *
+ */
+inline thread_local ThreadStats *thread_stats = nullptr;
+
+/**
+ * @brief Add to a counter of the calling thread
+ *
+ * @param counter_id The counter
+ * @param amount Amount to add
+ */
+inline void countStat(StatCounter counter_id, uint64_t amount = 1)
+{
+    if constexpr (kStatsEnabled)
+    {
+        ThreadStats &stats = thread_stats != nullptr ? *thread_stats : registerThreadStats();
+        std::atomic<uint64_t> &value = stats.counters[static_cast<size_t>(counter_id)];
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Times the enclosing scope into a timer of the calling thread
+ *
+ */
+class ScopedStatTimer
+{
+    StatTimer timer_id;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedStatTimer(StatTimer timer_id)
+        : timer_id(timer_id)
+    {
+        if constexpr (kStatsEnabled)
+        {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedStatTimer()
+    {
+        if constexpr (kStatsEnabled)
+        {
+            uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            ThreadStats &stats = thread_stats != nullptr ? *thread_stats : registerThreadStats();
+            std::atomic<uint64_t> &calls = stats.timer_calls[static_cast<size_t>(timer_id)];
+            std::atomic<uint64_t> &nanoseconds = stats.timer_nanoseconds[static_cast<size_t>(timer_id)];
+            calls.store(calls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            nanoseconds.store(nanoseconds.load(std::memory_order_relaxed) + elapsed, std::memory_order_relaxed);
+        }
+    }
+
+    ScopedStatTimer(const ScopedStatTimer &) = delete;
+    ScopedStatTimer &operator=(const ScopedStatTimer &) = delete;
+};
+
+/**
+ * @brief Sum the counters of every thread that has recorded anything. Takes no locks; counts still being written by other threads may
+ * be missed until the next call.
+ *
+ * @return The totals
+ */
+StatsSnapshot collectStats();
+
+/**
+ * @brief Get the name of a counter, as used in the dumps
+ *
+ * @param counter_id The counter
+ * @return A snake case name
+ */
+const char *statName(StatCounter counter_id);
+
+/**
+ * @brief Get the name of a timer, as used in the dumps
+ *
+ * @param timer_id The timer
+ * @return A snake case name
+ */
+const char *statName(StatTimer timer_id);
+
+/**
+ * @brief Write a snapshot as a JSON object with "counters" and "timers" members
+ *
+ * @param out Stream to write to
+ * @param snapshot The snapshot
+ */
+void writeStatsJson(std::ostream &out, const StatsSnapshot &snapshot);
+
+/**
+ * @brief Write a snapshot in the Prometheus text exposition format. Counters become tetris_<name>_total, timers become
+ * tetris_<name>_calls_total and tetris_<name>_seconds_total.
+ *
+ * @param out Stream to write to
+ * @param snapshot The snapshot
+ */
+void writeStatsPrometheus(std::ostream &out, const StatsSnapshot &snapshot);
+
+#endif // TETRIS_STATS_H
@@ -0,0 +1,110 @@
+#ifndef TETRIS_THREAD_POOL_H
+#define TETRIS_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Counts the outstanding tasks of one fork-join region and holds the first exception any of them threw. A group must outlive every
+ * task run in it.
+ *
+ */
+class TaskGroup
+{
+    friend class ThreadPool;
+    std::atomic<size_t> pending{0};
+    // Set by the first task to throw, which alone writes error. Read only once pending reaches zero.
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+};
+
+/**
+ * @brief Fork-join thread pool with one task deque per worker. Workers pop their own most recent task first and steal the oldest task
+ * from other workers when they run dry, so large subtrees spread across cores while small ones stay local.
+ *
+ */
+class ThreadPool
+{
+    struct Task
+    {
+        std::function<void()> work;
+        TaskGroup *group;
+    };
+
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    // Deque zero belongs to threads outside the pool, the rest to the worker threads
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    // Number of tasks sitting in deques, used to put idle workers to sleep
+    std::atomic<size_t> queued{0};
+    std::atomic<bool> stopping{false};
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+
+    // Index of the deque owned by the calling thread
+    size_t ownIndex() const;
+
+    // Pop a task from the calling thread's deque, or steal one from another deque. Returns false if every deque is empty.
+    bool takeTask(Task &task);
+
+    // Run a task and mark it complete in its group, recording what it throws in the group
+    void execute(Task &task);
+
+    // Main loop of worker thread worker_idx
+    void workerLoop(size_t worker_idx);
+
+public:
+    /**
+     * @brief Start a pool
+     *
+     * @param thread_count Number of worker threads. Zero uses one per hardware thread.
+     */
+    explicit ThreadPool(size_t thread_count = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * @brief Get the number of worker threads
+     *
+     * @return The number of worker threads
+     */
+    size_t threadCount() const
+    {
+        return threads.size();
+    }
+
+    /**
+     * @brief Queue a task as part of the given group. Tasks may themselves run further tasks and wait on their own groups. An exception
+     * thrown by a task is caught and handed to whoever waits on the group.
+     *
+     * @param group The group to count the task against
+     * @param work The task to run
+     */
+    void run(TaskGroup &group, std::function<void()> work);
+
+    /**
+     * @brief Block until every task in the group has finished. The calling thread runs queued tasks while it waits.
+     *
+     * @param group The group to wait for. After the call it may be reused for new tasks.
+     *
+     * @throws The first exception thrown by a task of the group, once every task of the group has finished
+     */
+    void wait(TaskGroup &group);
+};
+
+#endif // TETRIS_THREAD_POOL_H
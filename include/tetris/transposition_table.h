@@ -0,0 +1,108 @@
+#ifndef TETRIS_TRANSPOSITION_TABLE_H
+#define TETRIS_TRANSPOSITION_TABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "placement.h"
+
+/**
+ * @brief How a store decides whether to overwrite the entry already in its slot
+ *
+ */
+enum class ReplacementPolicy
+{
+    // Every store overwrites the slot
+    AlwaysReplace,
+    // A store only overwrites an entry from the current generation if it searched at least as deep
+    DepthPreferred,
+};
+
+/**
+ * @brief A cached search result
+ *
+ */
+struct TranspositionEntry
+{
+    // Score of the position, stored exactly so a cached subtree scores the same as a freshly searched one
+    double score;
+    // Number of plies searched below the position
+    uint8_t depth;
+    // Best placement of the piece to move
+    Placement best;
+};
+
+/**
+ * @brief Fixed-size, lock-free hash table of search results keyed by Zobrist hash. Each slot stores its score and data words and the key
+ * XORed with both of them, so a slot torn by concurrent writers simply fails verification on probe instead of needing a lock.
+ *
+ */
+class TranspositionTable
+{
+    // Padded to 32 bytes so no slot straddles a cache line
+    struct alignas(32) Slot
+    {
+        std::atomic<uint64_t> check{0};
+        std::atomic<uint64_t> score{0};
+        std::atomic<uint64_t> data{0};
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t slot_mask;
+    ReplacementPolicy policy;
+    uint8_t generation{0};
+
+public:
+    /**
+     * @brief Allocate a table
+     *
+     * @param memory_bytes Memory budget. The table uses the largest power of two number of slots which fits.
+     * @param policy Replacement policy for stores
+     *
+     * @throws std::invalid_argument if memory_bytes cannot hold a single slot
+     */
+    explicit TranspositionTable(size_t memory_bytes, ReplacementPolicy policy = ReplacementPolicy::DepthPreferred);
+
+    /**
+     * @brief Get the number of slots
+     *
+     * @return The number of slots
+     */
+    size_t capacity() const
+    {
+        return slot_mask + 1;
+    }
+
+    /**
+     * @brief Look up a position
+     *
+     * @param key Zobrist key of the position
+     * @param entry Set to the cached entry on a hit
+     * @return true If an entry for key was found
+     * @return false Otherwise
+     */
+    bool probe(uint64_t key, TranspositionEntry &entry) const;
+
+    /**
+     * @brief Cache a position, subject to the replacement policy
+     *
+     * @param key Zobrist key of the position
+     * @param entry The result to cache
+     */
+    void store(uint64_t key, const TranspositionEntry &entry);
+
+    /**
+     * @brief Start a new generation. Under DepthPreferred, entries from earlier generations are always replaced.
+     *
+     */
+    void newGeneration();
+
+    /**
+     * @brief Remove every entry. Not safe to call while other threads use the table.
+     *
+     */
+    void clear();
+};
+
+#endif // TETRIS_TRANSPOSITION_TABLE_H
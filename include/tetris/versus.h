@@ -0,0 +1,148 @@
+#ifndef TETRIS_VERSUS_H
+#define TETRIS_VERSUS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "board.h"
+#include "piece.h"
+#include "simulator.h"
+
+/**
+ * @brief Garbage rows sent for clearing the given number of lines with one piece, before combo and back-to-back bonuses
+ *
+ */
+constexpr std::array<uint8_t, kMaxPieceSize + 1> kClearAttack = {0, 0, 1, 2, 4, 5, 6, 7, 8};
+
+/**
+ * @brief Extra garbage rows sent by the nth consecutive clearing piece, counted from zero. Longer combos send the last entry.
+ *
+ */
+constexpr std::array<uint8_t, 13> kComboAttack = {0, 0, 1, 1, 1, 2, 2, 3, 3, 4, 4, 4, 5};
+
+/**
+ * @brief Clears of at least this many lines are difficult. Consecutive difficult clears, with no easier clear between them, earn
+ * kBackToBackAttack extra rows each.
+ *
+ */
+constexpr int kDifficultClear = 4;
+constexpr int kBackToBackAttack = 1;
+
+/**
+ * @brief Tracks the combo and back-to-back state of one player and converts their line clears into attack
+ *
+ */
+class AttackCounter
+{
+    // Consecutive clearing pieces minus one, or -1 if the last piece cleared nothing
+    int combo_count{-1};
+    bool back_to_back{false};
+    int longest_combo{0};
+    uint64_t back_to_back_count{0};
+    uint64_t total_attack{0};
+
+public:
+    /**
+     * @brief Record the outcome of one piece
+     *
+     * @param lines_cleared Lines the piece cleared, at most kMaxPieceSize
+     * @return Garbage rows the piece sends
+     */
+    int recordClear(int lines_cleared);
+
+    /**
+     * @brief Get the current combo
+     *
+     * @return Consecutive clearing pieces minus one, or -1 if the last piece cleared nothing
+     */
+    int combo() const
+    {
+        return combo_count;
+    }
+
+    /**
+     * @brief Determine whether the next difficult clear earns the back-to-back bonus
+     *
+     * @return true If the last clear was difficult
+     * @return false Otherwise
+     */
+    bool backToBack() const
+    {
+        return back_to_back;
+    }
+
+    /**
+     * @brief Get the longest combo reached so far
+     *
+     * @return The longest combo, or zero if nothing has been cleared
+     */
+    int longestCombo() const
+    {
+        return longest_combo;
+    }
+
+    /**
+     * @brief Get the number of clears which earned the back-to-back bonus
+     *
+     * @return The number of back-to-back clears
+     */
+    uint64_t backToBackCount() const
+    {
+        return back_to_back_count;
+    }
+
+    /**
+     * @brief Get the garbage rows sent so far, before cancellation against incoming garbage
+     *
+     * @return The total attack
+     */
+    uint64_t totalAttack() const
+    {
+        return total_attack;
+    }
+};
+
+/**
+ * @brief How one player of a versus game did
+ *
+ */
+struct VersusPlayerResult
+{
+    uint64_t pieces_placed;
+    uint64_t lines_cleared;
+    // Garbage rows sent to the opponent, after cancelling the player's own incoming garbage
+    uint64_t garbage_sent;
+    // Garbage rows pushed into the player's board
+    uint64_t garbage_received;
+    int longest_combo;
+    uint64_t back_to_back_count;
+    bool topped_out;
+};
+
+/**
+ * @brief Outcome of a versus game
+ *
+ */
+struct VersusResult
+{
+    uint64_t seed;
+    std::array<VersusPlayerResult, 2> players;
+    // Index of the player who did not top out, or -1 if the game reached the piece limit
+    int winner;
+};
+
+/**
+ * @brief Play two policies against each other on boards of their own, alternating pieces from the same sequence. Each piece's attack
+ * first cancels garbage waiting for the player who placed it and the rest is queued for the opponent. Queued garbage is pushed in,
+ * all with one random hole column, after the player's next piece which clears nothing. A player loses by topping out, including by
+ * being pushed over the top by garbage.
+ *
+ * @param seed Seed of the piece sequence and the garbage holes
+ * @param first Policy of player zero, who moves first
+ * @param second Policy of player one
+ * @param max_pieces Stop after each player has placed this many pieces
+ * @return The outcome of the game
+ */
+VersusResult playVersusGame(uint64_t seed, const Policy &first, const Policy &second, uint64_t max_pieces);
+
+#endif // TETRIS_VERSUS_H
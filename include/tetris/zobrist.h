@@ -0,0 +1,60 @@
+#ifndef TETRIS_ZOBRIST_H
+#define TETRIS_ZOBRIST_H
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include "piece.h"
+
+/**
+ * @brief Random key for every cell of a board up to kZobristMaxRows by kZobristMaxColumns. A board hash is the XOR of the keys of its filled cells.
+ *
+ */
+constexpr int kZobristMaxRows = 64;
+constexpr int kZobristMaxColumns = 64;
+constexpr std::array<std::array<uint64_t, kZobristMaxColumns>, kZobristMaxRows> kZobristCells = []
+{
+    std::array<std::array<uint64_t, kZobristMaxColumns>, kZobristMaxRows> keys{};
+    uint64_t counter = 0;
+    for (auto &row_keys : keys)
+    {
+        for (uint64_t &key : row_keys)
+        {
+            key = mixBits(++counter);
+        }
+    }
+    return keys;
+}();
+
+/**
+ * @brief Determine the XOR of the Zobrist keys of the filled cells of one board row
+ *
+ * @param row_idx The row the bits belong to
+ * @param bits The filled cells of the row, with bit i set if column i is filled
+ * @return The combined key
+ */
+constexpr uint64_t zobristRow(int row_idx, uint64_t bits)
+{
+    uint64_t key = 0;
+    while (bits != 0)
+    {
+        key ^= kZobristCells[row_idx][std::countr_zero(bits)];
+        bits &= bits - 1;
+    }
+    return key;
+}
+
+/**
+ * @brief Determine the Zobrist key of a piece about to be placed. Every orientation of a table-backed piece has the same key,
+ * since the placement search is free to choose the orientation.
+ *
+ * @param piece The piece
+ * @return The key to XOR into the board hash
+ */
+inline uint64_t zobristPiece(const TetrisPiece &piece)
+{
+    const TetrisPiece &base = piece.orientations != nullptr ? piece.orientations->pieces[0] : piece;
+    return mixBits(base.cells ^ (uint64_t{base.width} << 56) ^ (uint64_t{base.height} << 60));
+}
+
+#endif // TETRIS_ZOBRIST_H
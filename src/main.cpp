@@ -1,9 +1,174 @@
 #include <iostream>
 #include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <stdexcept>
 #include "tetris/piece.h"
+#include "tetris/piece_set.h"
+#include "tetris/simulator.h"
+#include "tetris/stats.h"
+#include "tetris/batch_runner.h"
 
-int main()
+namespace
 {
+    // Weights for the built-in greedy policy
+    const FeatureWeights kDefaultWeights{-0.51f, -0.18f, -0.36f, 0.76f, -0.05f};
+
+    // Print the engine counters when they are compiled in, as Prometheus text if TETRIS_STATS_FORMAT=prometheus and JSON otherwise
+    void dumpStats()
+    {
+        if constexpr (kStatsEnabled)
+        {
+            const char *format = std::getenv("TETRIS_STATS_FORMAT");
+            if (format != nullptr && std::string(format) == "prometheus")
+            {
+                writeStatsPrometheus(std::cout, collectStats());
+            }
+            else
+            {
+                writeStatsJson(std::cout, collectStats());
+            }
+        }
+    }
+
+    // Print why the arguments were rejected and how to call the program, returning the exit status to use
+    int usageError(const std::exception &error)
+    {
+        std::cerr << "error: " << error.what() << "\n";
+        std::cerr << "usage: main simulate [games] [seed] [max_pieces] [piece_set_file]\n";
+        std::cerr << "       main batch [games] [threads] [first_seed] [max_pieces] [piece_set_file]\n";
+        return 1;
+    }
+
+    // Parse a whole argument as a non-negative integer. std::stoull alone accepts trailing junk and wraps negative numbers.
+    uint64_t parseNumber(const char *arg, const char *name)
+    {
+        std::string text(arg);
+        size_t parsed = 0;
+        uint64_t value = 0;
+        try
+        {
+            if (!text.empty() && text[0] != '-')
+            {
+                value = std::stoull(text, &parsed);
+            }
+        }
+        catch (const std::exception &)
+        {
+            parsed = 0;
+        }
+        if (parsed == 0 || parsed != text.size())
+        {
+            throw std::invalid_argument(std::string(name) + " must be a non-negative integer, got \"" + text + "\"");
+        }
+        return value;
+    }
+
+    // Usage: main simulate [games] [seed] [max_pieces] [piece_set_file]
+    int runSimulation(int argc, char *argv[])
+    {
+        uint64_t games = 100;
+        uint64_t seed = 0;
+        uint64_t max_pieces = 10000;
+        PieceSet custom_pieces;
+        try
+        {
+            games = argc > 2 ? parseNumber(argv[2], "games") : games;
+            seed = argc > 3 ? parseNumber(argv[3], "seed") : seed;
+            max_pieces = argc > 4 ? parseNumber(argv[4], "max_pieces") : max_pieces;
+            if (argc > 5)
+            {
+                custom_pieces = PieceSet::load(argv[5]);
+            }
+        }
+        catch (const std::exception &error)
+        {
+            return usageError(error);
+        }
+        const PieceSet &pieces = argc > 5 ? custom_pieces : PieceSet::standard();
+
+        SimulationSummary summary = simulate(seed, games, greedyPolicy(kDefaultWeights), max_pieces, pieces);
+        std::cout << "games: " << summary.games << "\n";
+        std::cout << "pieces: " << summary.pieces_placed << "\n";
+        std::cout << "lines: " << summary.lines_cleared << "\n";
+        std::cout << "seconds: " << summary.seconds << "\n";
+        std::cout << "games/sec: " << summary.gamesPerSecond() << "\n";
+        std::cout << "pieces/sec: " << summary.piecesPerSecond() << "\n";
+        dumpStats();
+        return 0;
+    }
+
+    // Usage: main batch [games] [threads] [first_seed] [max_pieces] [piece_set_file]
+    int runBatchSimulation(int argc, char *argv[])
+    {
+        uint64_t games = 1000;
+        BatchOptions options;
+        options.thread_count = 0;
+        uint64_t first_seed = 0;
+        options.max_pieces = 10000;
+        PieceSet custom_pieces;
+        try
+        {
+            games = argc > 2 ? parseNumber(argv[2], "games") : games;
+            options.thread_count = argc > 3 ? parseNumber(argv[3], "threads") : options.thread_count;
+            first_seed = argc > 4 ? parseNumber(argv[4], "first_seed") : first_seed;
+            options.max_pieces = argc > 5 ? parseNumber(argv[5], "max_pieces") : options.max_pieces;
+            if (argc > 6)
+            {
+                custom_pieces = PieceSet::load(argv[6]);
+            }
+        }
+        catch (const std::exception &error)
+        {
+            return usageError(error);
+        }
+        options.piece_set = argc > 6 ? &custom_pieces : nullptr;
+
+        std::vector<uint64_t> seeds(games);
+        for (uint64_t game_idx = 0; game_idx < games; game_idx++)
+        {
+            seeds[game_idx] = first_seed + game_idx;
+        }
+        BatchResult result = runBatch(seeds, []
+                                      { return greedyPolicy(kDefaultWeights); },
+                                      options);
+
+        const BatchStatistics &statistics = result.statistics;
+        std::cout << "games: " << statistics.games << "\n";
+        std::cout << "pieces: " << statistics.pieces_placed << "\n";
+        std::cout << "lines: " << statistics.lines_cleared << "\n";
+        std::cout << "topped out: " << statistics.topped_out << "\n";
+        std::cout << "seconds: " << result.seconds << "\n";
+        std::cout << "pieces/sec: " << (result.seconds > 0 ? statistics.pieces_placed / result.seconds : 0) << "\n";
+        std::cout << "line clears by size:";
+        for (uint64_t count : statistics.clears_by_size)
+        {
+            std::cout << " " << count;
+        }
+        std::cout << "\nscore histogram (bucket width " << statistics.score_bucket_width << "):";
+        for (uint64_t count : statistics.score_histogram)
+        {
+            std::cout << " " << count;
+        }
+        std::cout << "\n";
+        dumpStats();
+        return 0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && std::string(argv[1]) == "simulate")
+    {
+        return runSimulation(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "batch")
+    {
+        return runBatchSimulation(argc, argv);
+    }
+
     TetrisPiece piece = TetrisPiece{{{false, true, false, true, false, true},
                                      {true, false, true, false, true, false},
                                      {false, true, false, true, false, true},
@@ -21,4 +186,4 @@ int main()
          {true, false, true, true, true}},
     };
     std::cout << piece2;
-}
\ No newline at end of file
+}
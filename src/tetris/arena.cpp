@@ -0,0 +1,55 @@
+#include "tetris/arena.h"
+#include <algorithm>
+#include <atomic>
+
+namespace
+{
+    std::atomic<uint64_t> reserved_allocations{0};
+    std::atomic<uint64_t> reserved_bytes{0};
+}
+
+ReservedMemory reservedMemory()
+{
+    return ReservedMemory{reserved_allocations.load(std::memory_order_relaxed), reserved_bytes.load(std::memory_order_relaxed)};
+}
+
+void countReservedMemory(size_t bytes)
+{
+    reserved_allocations.fetch_add(1, std::memory_order_relaxed);
+    reserved_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+Arena::Arena(size_t block_size)
+    : block_idx(0), offset(0), block_size(block_size), statistics{}
+{
+    if (block_size == 0)
+    {
+        throw std::invalid_argument("Arena block size must be greater than zero");
+    }
+}
+
+void *Arena::allocateSlow(size_t size, size_t alignment)
+{
+    // Blocks kept from before a rewind are reused in order. One too small for this allocation is skipped until the next rewind.
+    for (block_idx = blocks.empty() ? 0 : block_idx + 1; block_idx < blocks.size(); block_idx++)
+    {
+        uintptr_t base = reinterpret_cast<uintptr_t>(blocks[block_idx].memory.get());
+        uintptr_t aligned = (base + alignment - 1) & ~(uintptr_t{alignment} - 1);
+        if (aligned + size <= base + blocks[block_idx].size)
+        {
+            offset = aligned + size - base;
+            return reinterpret_cast<void *>(aligned);
+        }
+    }
+
+    size_t new_size = std::max(block_size, size + alignment);
+    blocks.push_back(Block{std::make_unique<std::byte[]>(new_size), new_size});
+    statistics.system_allocations++;
+    statistics.reserved_bytes += new_size;
+    countReservedMemory(new_size);
+
+    uintptr_t base = reinterpret_cast<uintptr_t>(blocks[block_idx].memory.get());
+    uintptr_t aligned = (base + alignment - 1) & ~(uintptr_t{alignment} - 1);
+    offset = aligned + size - base;
+    return reinterpret_cast<void *>(aligned);
+}
@@ -0,0 +1,125 @@
+#include "tetris/batch_runner.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+BatchStatistics::BatchStatistics(uint64_t score_bucket_width, size_t bucket_count)
+    : score_histogram(bucket_count, 0), score_bucket_width(score_bucket_width)
+{
+    if (score_bucket_width == 0 || bucket_count == 0)
+    {
+        throw std::invalid_argument("Score histogram needs a non-zero bucket width and bucket count");
+    }
+}
+
+void BatchStatistics::add(const GameResult &result)
+{
+    games++;
+    pieces_placed += result.pieces_placed;
+    lines_cleared += result.lines_cleared;
+    topped_out += result.topped_out;
+    total_score += result.score;
+    for (size_t size = 0; size < clears_by_size.size(); size++)
+    {
+        clears_by_size[size] += result.clears_by_size[size];
+    }
+    size_t bucket = std::min<uint64_t>(result.score / score_bucket_width, score_histogram.size() - 1);
+    score_histogram[bucket]++;
+}
+
+void BatchStatistics::merge(const BatchStatistics &other)
+{
+    if (other.score_bucket_width != score_bucket_width || other.score_histogram.size() != score_histogram.size())
+    {
+        throw std::invalid_argument("Cannot merge statistics with different histogram layouts");
+    }
+    games += other.games;
+    pieces_placed += other.pieces_placed;
+    lines_cleared += other.lines_cleared;
+    topped_out += other.topped_out;
+    total_score += other.total_score;
+    for (size_t size = 0; size < clears_by_size.size(); size++)
+    {
+        clears_by_size[size] += other.clears_by_size[size];
+    }
+    for (size_t bucket = 0; bucket < score_histogram.size(); bucket++)
+    {
+        score_histogram[bucket] += other.score_histogram[bucket];
+    }
+}
+
+BatchResult runBatch(std::span<const uint64_t> seeds, const PolicyFactory &make_policy, const BatchOptions &options)
+{
+    size_t thread_count = options.thread_count;
+    if (thread_count == 0)
+    {
+        thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    thread_count = std::max<size_t>(1, std::min(thread_count, seeds.size()));
+
+    BatchResult result{BatchStatistics(options.score_bucket_width, options.bucket_count), std::vector<GameResult>(seeds.size()), 0};
+    std::vector<BatchStatistics> thread_statistics(thread_count, result.statistics);
+    std::atomic<size_t> next_game{0};
+    const PieceSet &pieces = options.piece_set != nullptr ? *options.piece_set : PieceSet::standard();
+    auto start = std::chrono::steady_clock::now();
+
+    // Workers only touch their own statistics, error slot and the result slots of the games they claimed
+    std::vector<std::exception_ptr> errors(thread_count);
+    auto worker = [&](size_t thread_idx)
+    {
+        try
+        {
+            Policy policy = make_policy();
+            BatchStatistics &statistics = thread_statistics[thread_idx];
+            for (size_t game_idx = next_game.fetch_add(1, std::memory_order_relaxed); game_idx < seeds.size();
+                 game_idx = next_game.fetch_add(1, std::memory_order_relaxed))
+            {
+                result.games[game_idx] = playGame(seeds[game_idx], policy, options.max_pieces, nullptr, pieces);
+                statistics.add(result.games[game_idx]);
+            }
+        }
+        catch (...)
+        {
+            errors[thread_idx] = std::current_exception();
+            // Stop the other workers from claiming further games
+            next_game.store(seeds.size(), std::memory_order_relaxed);
+        }
+    };
+
+    // Every started thread is joined on every path, including a failure to start the rest
+    std::vector<std::thread> threads;
+    try
+    {
+        for (size_t thread_idx = 1; thread_idx < thread_count; thread_idx++)
+        {
+            threads.emplace_back(worker, thread_idx);
+        }
+        worker(0);
+    }
+    catch (...)
+    {
+        errors[0] = std::current_exception();
+        next_game.store(seeds.size(), std::memory_order_relaxed);
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    for (const std::exception_ptr &error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    for (const BatchStatistics &statistics : thread_statistics)
+    {
+        result.statistics.merge(statistics);
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
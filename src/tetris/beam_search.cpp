@@ -0,0 +1,207 @@
+#include "tetris/beam_search.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    constexpr double kLostGame = -std::numeric_limits<double>::infinity();
+}
+
+BeamSearch::BeamSearch(EvaluationFunction evaluate, ThreadPool &pool, BeamOptions options)
+    : evaluate(std::move(evaluate)), pool(pool), options(options)
+{
+    if (options.width == 0)
+    {
+        throw std::invalid_argument("Beam width must be at least one");
+    }
+    size_t child_slots = options.width * kMaxPlacements;
+    boards.resize(options.width);
+    lines.resize(options.width);
+    first_placements.resize(options.width);
+    next_boards.resize(options.width);
+    next_lines.resize(options.width);
+    next_first_placements.resize(options.width);
+    child_counts.resize(options.width);
+    child_placements.resize(child_slots);
+    child_scores.resize(child_slots);
+    child_keys.resize(child_slots);
+    child_cleared.resize(child_slots);
+    selection.resize(child_slots);
+    if (options.deduplicate)
+    {
+        // At most half full, so probe sequences stay short
+        dedup_positions.resize(std::bit_ceil(2 * child_slots));
+        dedup_stamps.resize(dedup_positions.size());
+    }
+}
+
+void BeamSearch::expand(size_t first, size_t last)
+{
+    std::array<Placement, kMaxPlacements> placements;
+    TetrisPiece piece = *layer_piece;
+    for (size_t node = first; node < last; node++)
+    {
+        // Each node belongs to one task, so its board is used as the scratch board and left as it was found
+        TetrisBoard &board = boards[node];
+        size_t count = enumeratePlacements(board, *layer_piece, placements);
+        child_counts[node] = static_cast<uint16_t>(count);
+        size_t base = node * kMaxPlacements;
+        for (size_t placement_idx = 0; placement_idx < count; placement_idx++)
+        {
+            const Placement &placement = placements[placement_idx];
+            piece.setOrientation(placement.orientation);
+            TetrisBoard::UndoRecord undo;
+            int cleared = board.makeMove(piece, placement.column, undo);
+            int total_lines = lines[node] + cleared;
+            child_placements[base + placement_idx] = placement;
+            child_scores[base + placement_idx] = evaluate(board, total_lines);
+            child_keys[base + placement_idx] = board.hash() ^ mixBits(static_cast<uint64_t>(total_lines));
+            child_cleared[base + placement_idx] = static_cast<uint8_t>(cleared);
+            board.unmakeMove(undo);
+        }
+    }
+}
+
+void BeamSearch::expandLayer()
+{
+    if (options.nodes_per_task == 0 || layer_size <= options.nodes_per_task)
+    {
+        expand(0, layer_size);
+        return;
+    }
+    TaskGroup group;
+    for (size_t first = 0; first < layer_size; first += options.nodes_per_task)
+    {
+        pool.run(group, [this, first]
+                 { expand(first, std::min(first + options.nodes_per_task, layer_size)); });
+    }
+    pool.wait(group);
+}
+
+size_t BeamSearch::deduplicate(size_t count)
+{
+    if (++dedup_stamp == 0)
+    {
+        std::fill(dedup_stamps.begin(), dedup_stamps.end(), 0);
+        dedup_stamp = 1;
+    }
+    size_t mask = dedup_positions.size() - 1;
+    size_t kept = 0;
+    for (size_t selection_idx = 0; selection_idx < count; selection_idx++)
+    {
+        uint32_t child = selection[selection_idx];
+        uint64_t key = child_keys[child];
+        size_t slot = key & mask;
+        while (dedup_stamps[slot] == dedup_stamp && child_keys[selection[dedup_positions[slot]]] != key)
+        {
+            slot = (slot + 1) & mask;
+        }
+        if (dedup_stamps[slot] != dedup_stamp)
+        {
+            dedup_stamps[slot] = dedup_stamp;
+            dedup_positions[slot] = static_cast<uint32_t>(kept);
+            selection[kept++] = child;
+            continue;
+        }
+        beam_counters.duplicates++;
+        uint32_t &existing = selection[dedup_positions[slot]];
+        if (child_scores[child] > child_scores[existing])
+        {
+            existing = child;
+        }
+    }
+    return kept;
+}
+
+SearchResult BeamSearch::search(const TetrisBoard &board, std::span<const TetrisPiece> pieces)
+{
+    if (pieces.empty())
+    {
+        throw std::invalid_argument("Search needs at least one piece");
+    }
+
+    boards[0] = board;
+    lines[0] = 0;
+    layer_size = 1;
+    SearchResult result{Placement{}, kLostGame, false};
+    auto better = [this](uint32_t first, uint32_t second)
+    {
+        if (child_scores[first] != child_scores[second])
+        {
+            return child_scores[first] > child_scores[second];
+        }
+        return first < second;
+    };
+
+    size_t ply = 0;
+    for (; ply < pieces.size(); ply++)
+    {
+        layer_piece = &pieces[ply];
+        expandLayer();
+
+        size_t count = 0;
+        for (size_t node = 0; node < layer_size; node++)
+        {
+            size_t base = node * kMaxPlacements;
+            for (size_t child_idx = 0; child_idx < child_counts[node]; child_idx++)
+            {
+                selection[count++] = static_cast<uint32_t>(base + child_idx);
+            }
+        }
+        beam_counters.expanded += layer_size;
+        beam_counters.candidates += count;
+        if (count == 0)
+        {
+            // Every line has topped out
+            break;
+        }
+        if (options.deduplicate)
+        {
+            count = deduplicate(count);
+        }
+
+        // Keep the best children without sorting the rest, then restore the order they were generated in, so the layer stays ordered
+        // by first placement and ties keep going to the placement enumerated first
+        size_t kept = std::min(count, options.width);
+        if (count > kept)
+        {
+            std::nth_element(selection.begin(), selection.begin() + kept, selection.begin() + count, better);
+            beam_counters.pruned += count - kept;
+        }
+        std::sort(selection.begin(), selection.begin() + kept);
+
+        TetrisPiece piece = pieces[ply];
+        size_t best_idx = 0;
+        for (size_t node = 0; node < kept; node++)
+        {
+            uint32_t child = selection[node];
+            size_t parent = child / kMaxPlacements;
+            const Placement &placement = child_placements[child];
+            piece.setOrientation(placement.orientation);
+            next_boards[node] = boards[parent];
+            next_boards[node].addPiece(piece, placement.column);
+            next_lines[node] = lines[parent] + child_cleared[child];
+            next_first_placements[node] = ply == 0 ? placement : first_placements[parent];
+            if (child_scores[child] > child_scores[selection[best_idx]])
+            {
+                best_idx = node;
+            }
+        }
+        result = SearchResult{next_first_placements[best_idx], child_scores[selection[best_idx]], true};
+
+        std::swap(boards, next_boards);
+        std::swap(lines, next_lines);
+        std::swap(first_placements, next_first_placements);
+        layer_size = kept;
+    }
+
+    if (ply < pieces.size())
+    {
+        result.score = kLostGame;
+    }
+    return result;
+}
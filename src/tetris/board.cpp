@@ -0,0 +1,287 @@
+#include "tetris/board.h"
+
+template class BasicTetrisBoard<10, 30>;
+template std::ostream &operator<<(std::ostream &outs, const TetrisBoard &board);
+
+DynamicTetrisBoard::DynamicTetrisBoard(int width, int height)
+    : board_width(width), board_height(height)
+{
+    if (width < 1 || width > kZobristMaxColumns || height < 1 || height > kZobristMaxRows)
+    {
+        throw std::invalid_argument("Board dimensions must be between one and the size of the Zobrist key table");
+    }
+    full_row = std::numeric_limits<Row>::max() >> (std::numeric_limits<Row>::digits - width);
+    rows.assign(height, 0);
+    column_heights.assign(width, 0);
+    column_cells.assign(width, 0);
+}
+
+bool DynamicTetrisBoard::collides(const TetrisPiece &piece, int col_offset, int row_offset) const
+{
+    countStat(StatCounter::CollisionChecks);
+    if (col_offset < 0 || row_offset < 0 || col_offset + piece.width > board_width || row_offset + piece.height > board_height)
+    {
+        return true;
+    }
+    for (int row_idx = 0; row_idx < piece.height; row_idx++)
+    {
+        if (rows[row_offset + row_idx] & (Row{piece.row(row_idx)} << col_offset))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int DynamicTetrisBoard::landingRow(const TetrisPiece &piece, int col_offset) const
+{
+    int row_idx = 0;
+    for (int piece_col = 0; piece_col < piece.width; piece_col++)
+    {
+        row_idx = std::max(row_idx, column_heights[col_offset + piece_col] - piece.skirt[piece_col]);
+    }
+    return row_idx;
+}
+
+int DynamicTetrisBoard::addPiece(const TetrisPiece &piece, int col_offset)
+{
+    UndoRecord undo;
+    return makeMove(piece, col_offset, undo);
+}
+
+int DynamicTetrisBoard::makeMove(const TetrisPiece &piece, int col_offset, UndoRecord &undo)
+{
+    countStat(StatCounter::AddPiece);
+    ScopedStatTimer timer(StatTimer::AddPiece);
+    if (col_offset < 0 || col_offset + piece.width > board_width)
+    {
+        throw std::out_of_range("Piece does not fit on the board at the given column");
+    }
+
+    int row_offset = landingRow(piece, col_offset);
+    if (row_offset + piece.height > board_height)
+    {
+        throw std::overflow_error("Piece lands above the top of the board");
+    }
+    undo.piece_cells = piece.cells;
+    undo.piece_width = piece.width;
+    undo.piece_height = piece.height;
+    undo.col_offset = static_cast<uint8_t>(col_offset);
+    undo.row_offset = static_cast<uint8_t>(row_offset);
+    for (int piece_col = 0; piece_col < piece.width; piece_col++)
+    {
+        undo.column_heights[piece_col] = column_heights[col_offset + piece_col];
+    }
+    undo.max_height = max_height;
+    undo.hole_count = hole_count;
+    undo.hash = hash_value;
+
+    for (int row_idx = 0; row_idx < piece.height; row_idx++)
+    {
+        Row piece_row = Row{piece.row(row_idx)} << col_offset;
+        rows[row_offset + row_idx] |= piece_row;
+        hash_value ^= zobristRow(row_offset + row_idx, piece_row);
+    }
+    for (int piece_col = 0; piece_col < piece.width; piece_col++)
+    {
+        uint64_t column = (piece.cells >> piece_col) & kPieceColumnMask;
+        if (column == 0)
+        {
+            continue;
+        }
+        int col_idx = col_offset + piece_col;
+        int old_holes = holesInColumn(col_idx);
+        column_heights[col_idx] = std::max<int>(column_heights[col_idx], row_offset + piece.top[piece_col]);
+        column_cells[col_idx] += std::popcount(column);
+        hole_count += holesInColumn(col_idx) - old_holes;
+        max_height = std::max<int>(max_height, column_heights[col_idx]);
+    }
+
+    undo.cleared_rows = clearLines(row_offset, row_offset + piece.height - 1);
+    return undo.cleared_rows != 0 ? std::popcount(undo.cleared_rows) : 0;
+}
+
+void DynamicTetrisBoard::unmakeMove(const UndoRecord &undo)
+{
+    int cleared = std::popcount(undo.cleared_rows);
+    if (cleared > 0)
+    {
+        // Move the rows above each cleared row back up and refill it, working from the top down
+        int top = std::max<int>(undo.max_height, undo.row_offset + undo.piece_height);
+        int shift = cleared;
+        for (int row_idx = top - 1; shift > 0; row_idx--)
+        {
+            if ((undo.cleared_rows >> row_idx) & 1)
+            {
+                rows[row_idx] = full_row;
+                shift--;
+            }
+            else
+            {
+                rows[row_idx] = rows[row_idx - shift];
+            }
+        }
+    }
+    for (int row_idx = 0; row_idx < undo.piece_height; row_idx++)
+    {
+        rows[undo.row_offset + row_idx] ^= Row{static_cast<uint8_t>(undo.piece_cells >> (row_idx * kMaxPieceSize))} << undo.col_offset;
+    }
+
+    if (cleared > 0)
+    {
+        rescan();
+        return;
+    }
+    for (int piece_col = 0; piece_col < undo.piece_width; piece_col++)
+    {
+        column_heights[undo.col_offset + piece_col] = undo.column_heights[piece_col];
+        column_cells[undo.col_offset + piece_col] -= std::popcount((undo.piece_cells >> piece_col) & kPieceColumnMask);
+    }
+    max_height = undo.max_height;
+    hole_count = undo.hole_count;
+    hash_value = undo.hash;
+}
+
+DynamicTetrisBoard::Row DynamicTetrisBoard::clearLines(int first_row, int last_row)
+{
+    // Rows below first_row cannot be full, so nothing below it moves
+    Row cleared_rows = 0;
+    int write_idx = first_row;
+    for (int read_idx = first_row; read_idx < max_height; read_idx++)
+    {
+        if (read_idx <= last_row && rows[read_idx] == full_row)
+        {
+            cleared_rows |= Row{1} << read_idx;
+            continue;
+        }
+        rows[write_idx++] = rows[read_idx];
+    }
+    int cleared = max_height - write_idx;
+    if (cleared == 0)
+    {
+        return 0;
+    }
+    ScopedStatTimer timer(StatTimer::LineClear);
+    countStat(StatCounter::LineClears);
+    countStat(StatCounter::LinesCleared, cleared);
+    std::fill(rows.begin() + write_idx, rows.begin() + max_height, 0);
+
+    // Line clears are rare, so rescan every column and rehash rather than updating incrementally
+    rescan();
+    return cleared_rows;
+}
+
+DynamicTetrisBoard::Row DynamicTetrisBoard::fullRows() const
+{
+    Row full = 0;
+    for (int row_idx = 0; row_idx < max_height; row_idx++)
+    {
+        full |= Row{rows[row_idx] == full_row} << row_idx;
+    }
+    return full;
+}
+
+int DynamicTetrisBoard::clearRows(Row rows_to_clear)
+{
+    if (rows_to_clear == 0)
+    {
+        return 0;
+    }
+    if ((rows_to_clear & ~fullRows()) != 0)
+    {
+        throw std::invalid_argument("Only full rows can be cleared");
+    }
+
+    int write_idx = std::countr_zero(rows_to_clear);
+    for (int read_idx = write_idx; read_idx < max_height; read_idx++)
+    {
+        rows[write_idx] = rows[read_idx];
+        write_idx += !((rows_to_clear >> read_idx) & 1);
+    }
+    std::fill(rows.begin() + write_idx, rows.begin() + max_height, 0);
+    rescan();
+    return std::popcount(rows_to_clear);
+}
+
+void DynamicTetrisBoard::insertGarbage(int count, int hole_column)
+{
+    if (count < 0)
+    {
+        throw std::invalid_argument("Garbage row count must not be negative");
+    }
+    if (hole_column < 0 || hole_column >= board_width)
+    {
+        throw std::out_of_range("Garbage hole column out of range");
+    }
+    if (max_height + count > board_height)
+    {
+        throw std::overflow_error("Garbage pushes the stack above the top of the board");
+    }
+    if (count == 0)
+    {
+        return;
+    }
+
+    std::copy_backward(rows.begin(), rows.begin() + max_height, rows.begin() + max_height + count);
+    std::fill(rows.begin(), rows.begin() + count, full_row & ~(Row{1} << hole_column));
+    rescan();
+}
+
+void DynamicTetrisBoard::rescan()
+{
+    hash_value = 0;
+    hole_count = 0;
+    max_height = 0;
+    std::fill(column_heights.begin(), column_heights.end(), 0);
+    std::fill(column_cells.begin(), column_cells.end(), 0);
+    for (int row_idx = 0; row_idx < board_height; row_idx++)
+    {
+        hash_value ^= zobristRow(row_idx, rows[row_idx]);
+        for (Row bits = rows[row_idx]; bits != 0; bits &= bits - 1)
+        {
+            int col_idx = std::countr_zero(bits);
+            column_heights[col_idx] = row_idx + 1;
+            column_cells[col_idx]++;
+        }
+    }
+    for (int col_idx = 0; col_idx < board_width; col_idx++)
+    {
+        hole_count += holesInColumn(col_idx);
+        max_height = std::max<int>(max_height, column_heights[col_idx]);
+    }
+}
+
+int DynamicTetrisBoard::highestBlockInColumn(int col_idx) const
+{
+    if (col_idx < 0 || col_idx >= board_width)
+    {
+        throw std::out_of_range("Column index out of range");
+    }
+
+    return column_heights[col_idx] - 1;
+}
+
+std::ostream &operator<<(std::ostream &outs, const DynamicTetrisBoard &board)
+{
+    std::string horizontal_bar(board.width() + 2, '-');
+    horizontal_bar += '\n';
+    outs << horizontal_bar;
+    for (int row_idx = board.height(); row_idx-- > 0;)
+    {
+        outs << '|';
+        for (int col_idx = 0; col_idx < board.width(); col_idx++)
+        {
+            if (board.at(col_idx, row_idx))
+            {
+                outs << 'X';
+            }
+            else
+            {
+                outs << ' ';
+            }
+        }
+        outs << "|\n";
+    }
+    outs << horizontal_bar;
+    return outs;
+}
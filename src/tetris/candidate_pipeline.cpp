@@ -0,0 +1,155 @@
+#include "tetris/candidate_pipeline.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    // Enumeration order, which is orientation then column
+    bool enumeratedBefore(const ScoredCandidate &first, const ScoredCandidate &second)
+    {
+        if (first.placement.orientation != second.placement.orientation)
+        {
+            return first.placement.orientation < second.placement.orientation;
+        }
+        return first.placement.column < second.placement.column;
+    }
+
+    // Better estimate first, then enumeration order
+    bool betterEstimate(const ScoredCandidate &first, const ScoredCandidate &second)
+    {
+        if (first.estimate != second.estimate)
+        {
+            return first.estimate > second.estimate;
+        }
+        return enumeratedBefore(first, second);
+    }
+}
+
+BoardFeatures estimateFeatures(const TetrisBoard &board, const TetrisPiece &piece, const Placement &placement)
+{
+    BoardFeatures features{0, 0, board.holes(), 0, std::max(board.maxHeight(), placement.row + piece.height)};
+    for (int col_idx = 0; col_idx < TetrisBoard::width; col_idx++)
+    {
+        features.aggregate_height += board.columnHeight(col_idx);
+    }
+    for (int piece_col = 0; piece_col < piece.width; piece_col++)
+    {
+        uint64_t column = (piece.cells >> piece_col) & kPieceColumnMask;
+        if (column == 0)
+        {
+            continue;
+        }
+        int old_height = board.columnHeight(placement.column + piece_col);
+        // The gap under the skirt, plus any gaps between the cells of the piece in this column
+        features.holes += placement.row + piece.skirt[piece_col] - old_height;
+        features.holes += piece.top[piece_col] - piece.skirt[piece_col] - std::popcount(column);
+        features.aggregate_height += placement.row + piece.top[piece_col] - old_height;
+    }
+    for (int row_idx = 0; row_idx < piece.height; row_idx++)
+    {
+        TetrisBoard::Row merged = board.row(placement.row + row_idx) | (TetrisBoard::Row{piece.row(row_idx)} << placement.column);
+        features.completed_lines += merged == TetrisBoard::kFullRow;
+    }
+    features.aggregate_height -= features.completed_lines * TetrisBoard::width;
+    features.max_height -= features.completed_lines;
+    return features;
+}
+
+PipelineCounters &PipelineCounters::operator+=(const PipelineCounters &other)
+{
+    enumerated += other.enumerated;
+    estimated += other.estimated;
+    pruned += other.pruned;
+    evaluated += other.evaluated;
+    return *this;
+}
+
+CandidatePipeline::CandidatePipeline(const FeatureWeights &estimate_weights, EvaluationFunction evaluate, PipelineOptions options)
+    : estimate_weights(estimate_weights), evaluate(std::move(evaluate)), options(options)
+{
+}
+
+size_t CandidatePipeline::survivors(const TetrisBoard &board, const TetrisPiece &piece, std::span<ScoredCandidate> out)
+{
+    if (out.size() < kMaxPlacements)
+    {
+        throw std::invalid_argument("Candidate buffer must hold at least kMaxPlacements entries");
+    }
+
+    std::array<Placement, kMaxPlacements> placements;
+    size_t count = enumeratePlacements(board, piece, placements);
+    stage_counters.enumerated += count;
+    for (size_t placement_idx = 0; placement_idx < count; placement_idx++)
+    {
+        out[placement_idx] = ScoredCandidate{placements[placement_idx], 0.0f, 0.0};
+    }
+    if (!options.prune || options.keep == 0 || count <= options.keep)
+    {
+        return count;
+    }
+
+    // Stage one: estimate every placement
+    TetrisPiece oriented = piece;
+    for (size_t placement_idx = 0; placement_idx < count; placement_idx++)
+    {
+        ScoredCandidate &candidate = out[placement_idx];
+        oriented.setOrientation(candidate.placement.orientation);
+        candidate.estimate = scoreFeatures(estimateFeatures(board, oriented, candidate.placement), estimate_weights);
+    }
+    stage_counters.estimated += count;
+
+    // Stage two: move the best estimates to the front without sorting the rest, then put the survivors back in enumeration order so
+    // ties in the full evaluation still go to the placement enumerated first
+    auto first = out.begin();
+    auto kept_end = first + static_cast<std::ptrdiff_t>(options.keep);
+    std::nth_element(first, kept_end, first + static_cast<std::ptrdiff_t>(count), betterEstimate);
+    std::sort(first, kept_end, enumeratedBefore);
+    stage_counters.pruned += count - options.keep;
+    return options.keep;
+}
+
+std::optional<ScoredCandidate> CandidatePipeline::best(const TetrisBoard &board, const TetrisPiece &piece)
+{
+    std::array<ScoredCandidate, kMaxPlacements> candidates;
+    size_t count = survivors(board, piece, candidates);
+
+    // Stage three: place each survivor on one scratch board, undoing the move after scoring it
+    std::optional<ScoredCandidate> best;
+    TetrisBoard child = board;
+    TetrisPiece oriented = piece;
+    for (size_t candidate_idx = 0; candidate_idx < count; candidate_idx++)
+    {
+        ScoredCandidate &candidate = candidates[candidate_idx];
+        oriented.setOrientation(candidate.placement.orientation);
+        TetrisBoard::UndoRecord undo;
+        int cleared = child.makeMove(oriented, candidate.placement.column, undo);
+        candidate.score = evaluate(child, cleared);
+        child.unmakeMove(undo);
+        if (!best || candidate.score > best->score)
+        {
+            best = candidate;
+        }
+    }
+    stage_counters.evaluated += count;
+    return best;
+}
+
+Policy pipelinePolicy(const FeatureWeights &weights, PipelineOptions options)
+{
+    EvaluationFunction evaluate = [weights](const TetrisBoard &board, int lines_cleared)
+    {
+        return static_cast<double>(scoreFeatures(computeFeatures(board, lines_cleared), weights));
+    };
+    return [pipeline = CandidatePipeline(weights, std::move(evaluate), options)](const TetrisBoard &board, const TetrisPiece &piece) mutable -> std::optional<Placement>
+    {
+        std::optional<ScoredCandidate> best = pipeline.best(board, piece);
+        if (!best)
+        {
+            return std::nullopt;
+        }
+        return best->placement;
+    };
+}
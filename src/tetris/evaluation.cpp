@@ -0,0 +1,140 @@
+#include "tetris/evaluation.h"
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TETRIS_HAVE_AVX2_KERNEL 1
+#endif
+
+void BoardBatch::set(size_t lane, const TetrisBoard &board, int lines_cleared)
+{
+    if (lane >= kBatchSize)
+    {
+        throw std::out_of_range("Batch lane out of range");
+    }
+    for (int col_idx = 0; col_idx < TetrisBoard::width; col_idx++)
+    {
+        column_heights[col_idx][lane] = board.columnHeight(col_idx);
+    }
+    holes[lane] = board.holes();
+    completed_lines[lane] = lines_cleared;
+    count = std::max(count, lane + 1);
+}
+
+BoardFeatures FeatureBatch::lane(size_t lane) const
+{
+    return BoardFeatures{aggregate_height[lane], bumpiness[lane], holes[lane], completed_lines[lane], max_height[lane]};
+}
+
+BoardFeatures computeFeatures(const TetrisBoard &board, int lines_cleared)
+{
+    BoardFeatures features{0, 0, board.holes(), lines_cleared, board.maxHeight()};
+    for (int col_idx = 0; col_idx < TetrisBoard::width; col_idx++)
+    {
+        features.aggregate_height += board.columnHeight(col_idx);
+    }
+    for (int col_idx = 0; col_idx + 1 < TetrisBoard::width; col_idx++)
+    {
+        features.bumpiness += std::abs(board.columnHeight(col_idx) - board.columnHeight(col_idx + 1));
+    }
+    return features;
+}
+
+float scoreFeatures(const BoardFeatures &features, const FeatureWeights &weights)
+{
+    // Same operation order as the batch kernels, so every implementation produces identical scores
+    float score = static_cast<float>(features.aggregate_height) * weights.aggregate_height;
+    score += static_cast<float>(features.bumpiness) * weights.bumpiness;
+    score += static_cast<float>(features.holes) * weights.holes;
+    score += static_cast<float>(features.completed_lines) * weights.completed_lines;
+    score += static_cast<float>(features.max_height) * weights.max_height;
+    return score;
+}
+
+void evaluateBatchScalar(const BoardBatch &batch, const FeatureWeights &weights, FeatureBatch &out)
+{
+    for (size_t lane = 0; lane < kBatchSize; lane++)
+    {
+        BoardFeatures features{0, 0, batch.holes[lane], batch.completed_lines[lane], 0};
+        for (int col_idx = 0; col_idx < TetrisBoard::width; col_idx++)
+        {
+            int col_height = batch.column_heights[col_idx][lane];
+            features.aggregate_height += col_height;
+            features.max_height = std::max(features.max_height, col_height);
+            if (col_idx + 1 < TetrisBoard::width)
+            {
+                features.bumpiness += std::abs(col_height - batch.column_heights[col_idx + 1][lane]);
+            }
+        }
+        out.aggregate_height[lane] = features.aggregate_height;
+        out.bumpiness[lane] = features.bumpiness;
+        out.holes[lane] = features.holes;
+        out.completed_lines[lane] = features.completed_lines;
+        out.max_height[lane] = features.max_height;
+        out.scores[lane] = scoreFeatures(features, weights);
+    }
+}
+
+#ifdef TETRIS_HAVE_AVX2_KERNEL
+
+__attribute__((target("avx2"))) void evaluateBatchAvx2(const BoardBatch &batch, const FeatureWeights &weights, FeatureBatch &out)
+{
+    // Each lane of every register belongs to a different board, so the column loop runs once for all of them
+    __m256i previous = _mm256_load_si256(reinterpret_cast<const __m256i *>(batch.column_heights[0].data()));
+    __m256i aggregate_height = previous;
+    __m256i max_height = previous;
+    __m256i bumpiness = _mm256_setzero_si256();
+    for (int col_idx = 1; col_idx < TetrisBoard::width; col_idx++)
+    {
+        __m256i current = _mm256_load_si256(reinterpret_cast<const __m256i *>(batch.column_heights[col_idx].data()));
+        aggregate_height = _mm256_add_epi32(aggregate_height, current);
+        max_height = _mm256_max_epi32(max_height, current);
+        bumpiness = _mm256_add_epi32(bumpiness, _mm256_abs_epi32(_mm256_sub_epi32(current, previous)));
+        previous = current;
+    }
+    __m256i holes = _mm256_load_si256(reinterpret_cast<const __m256i *>(batch.holes.data()));
+    __m256i completed_lines = _mm256_load_si256(reinterpret_cast<const __m256i *>(batch.completed_lines.data()));
+
+    _mm256_store_si256(reinterpret_cast<__m256i *>(out.aggregate_height.data()), aggregate_height);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(out.bumpiness.data()), bumpiness);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(out.holes.data()), holes);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(out.completed_lines.data()), completed_lines);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(out.max_height.data()), max_height);
+
+    // Separate multiply and add, in the same order as scoreFeatures, to match the scalar results exactly
+    __m256 score = _mm256_mul_ps(_mm256_cvtepi32_ps(aggregate_height), _mm256_set1_ps(weights.aggregate_height));
+    score = _mm256_add_ps(score, _mm256_mul_ps(_mm256_cvtepi32_ps(bumpiness), _mm256_set1_ps(weights.bumpiness)));
+    score = _mm256_add_ps(score, _mm256_mul_ps(_mm256_cvtepi32_ps(holes), _mm256_set1_ps(weights.holes)));
+    score = _mm256_add_ps(score, _mm256_mul_ps(_mm256_cvtepi32_ps(completed_lines), _mm256_set1_ps(weights.completed_lines)));
+    score = _mm256_add_ps(score, _mm256_mul_ps(_mm256_cvtepi32_ps(max_height), _mm256_set1_ps(weights.max_height)));
+    _mm256_store_ps(out.scores.data(), score);
+}
+
+bool avx2Supported()
+{
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+#else
+
+void evaluateBatchAvx2(const BoardBatch &batch, const FeatureWeights &weights, FeatureBatch &out)
+{
+    evaluateBatchScalar(batch, weights, out);
+}
+
+bool avx2Supported()
+{
+    return false;
+}
+
+#endif
+
+void evaluateBatch(const BoardBatch &batch, const FeatureWeights &weights, FeatureBatch &out)
+{
+    // Resolved once, on first use
+    static const auto implementation = avx2Supported() ? evaluateBatchAvx2 : evaluateBatchScalar;
+    implementation(batch, weights, out);
+}
@@ -2,197 +2,194 @@
 #include <stdexcept>
 #include <iostream>
 #include <vector>
-#include <map>
 #include <limits>
-#include <functional>
+#include <bit>
+
+namespace
+{
+    // Orientation reached by applying each transformation to a piece in orientation o (see kOrientationCount)
+    constexpr std::array<uint8_t, kOrientationCount> kClockwise = {1, 2, 3, 0, 5, 6, 7, 4};
+    constexpr std::array<uint8_t, kOrientationCount> kCounterClockwise = {3, 0, 1, 2, 7, 4, 5, 6};
+    constexpr std::array<uint8_t, kOrientationCount> kHalfTurn = {2, 3, 0, 1, 6, 7, 4, 5};
+    constexpr std::array<uint8_t, kOrientationCount> kHorizontalFlip = {4, 7, 6, 5, 0, 3, 2, 1};
+    constexpr std::array<uint8_t, kOrientationCount> kVerticalFlip = {6, 5, 4, 7, 2, 1, 0, 3};
+
+    // Orientation which undoes each orientation. Mirrored orientations are their own inverse.
+    constexpr std::array<uint8_t, kOrientationCount> kInverse = {0, 3, 2, 1, 4, 5, 6, 7};
+}
 
 TetrisPiece::TetrisPiece(std::vector<std::vector<bool>> shape)
 {
-    // Height must be greater than zero
-    if ((width = shape.size()) == 0)
+    // Width must be greater than zero
+    if (shape.size() == 0)
     {
         throw std::invalid_argument("Width of piece must be greater than zero");
     }
 
     // All columns must have the same height
-    height = shape.at(0).size();
-    for (auto row : shape)
+    size_t shape_height = shape.at(0).size();
+    for (const auto &col : shape)
     {
-        if (row.size() != height)
+        if (col.size() != shape_height)
         {
             throw std::invalid_argument("Tetris piece must have uniform height");
         }
     }
 
     // Height must be greater than zero
-    if (height == 0)
+    if (shape_height == 0)
     {
         throw std::invalid_argument("Tetris piece height must be greater than zero");
     }
 
-    // Initialize grid
-    grid = new std::vector<std::vector<bool> *>(width);
-    for (size_t col_idx = 0; col_idx < width; col_idx++)
-    {
-        (*grid)[col_idx] = new std::vector<bool>(shape.at(col_idx));
-    }
-}
-
-TetrisPiece::~TetrisPiece()
-{
-    for (size_t i = 0; i < width; i++)
+    // Both dimensions must fit in the bitmask
+    if (shape.size() > kMaxPieceSize || shape_height > kMaxPieceSize)
     {
-        delete grid->at(i);
+        throw std::invalid_argument("Tetris piece dimensions must not exceed kMaxPieceSize");
     }
-    delete grid;
-}
 
-bool TetrisPiece::operator==(const TetrisPiece &p) const
-{
-    if (width != p.width || height != p.height)
-    {
-        return false;
-    }
+    countStat(StatCounter::PieceConstructions);
+    width = static_cast<uint8_t>(shape.size());
+    height = static_cast<uint8_t>(shape_height);
+    orientation = 0;
+    orientations = nullptr;
 
-    for (size_t col_idx = 0; col_idx < width; ++col_idx)
+    // Pack the shape into the bitmask
+    cells = 0;
+    for (size_t col_idx = 0; col_idx < width; col_idx++)
     {
-        for (size_t row_idx = 0; row_idx < height; ++row_idx)
+        for (size_t row_idx = 0; row_idx < height; row_idx++)
         {
-            if (grid->at(col_idx)->at(row_idx) != p.grid->at(col_idx)->at(row_idx))
+            if (shape[col_idx][row_idx])
             {
-                return false;
+                cells |= uint64_t{1} << (row_idx * kMaxPieceSize + col_idx);
             }
         }
     }
-
-    return true;
+    computeProfile();
 }
 
 void TetrisPiece::flipHorizontal()
 {
-    for (size_t col_idx = 0; col_idx < width / 2; col_idx++)
+    countStat(StatCounter::Rotations);
+    if (orientations != nullptr)
     {
-        std::vector<bool> *temp_col = grid->at(col_idx);
-        grid->at(col_idx) = grid->at(width - col_idx - 1);
-        grid->at(width - col_idx - 1) = temp_col;
+        *this = orientations->pieces[kHorizontalFlip[orientation]];
+        return;
     }
+
+    // Mirror into the high columns, then shift back down to column zero
+    cells = mirrorPieceRows(cells) >> (kMaxPieceSize - width);
+    orientation = kHorizontalFlip[orientation];
+    computeProfile();
 }
 
 void TetrisPiece::flipVertical()
 {
-    for (size_t col_idx = 0; col_idx < width; col_idx++)
+    countStat(StatCounter::Rotations);
+    if (orientations != nullptr)
     {
-        std::vector<bool> &col = *(grid->at(col_idx));
-        for (size_t row_idx = 0; row_idx < height / 2; row_idx++)
-        {
-            bool temp_val = col.at(row_idx);
-            col.at(row_idx) = col.at(height - row_idx - 1);
-            col.at(height - row_idx - 1) = temp_val;
-        }
+        *this = orientations->pieces[kVerticalFlip[orientation]];
+        return;
     }
+
+    // Mirror into the high rows, then shift back down to row zero
+    cells = mirrorPieceColumns(cells) >> ((kMaxPieceSize - height) * kMaxPieceSize);
+    orientation = kVerticalFlip[orientation];
+    computeProfile();
 }
 
 void TetrisPiece::rotateCounterClockwise()
 {
-    // Create new grid
-    std::vector<std::vector<bool> *> *new_grid = new std::vector<std::vector<bool> *>(height);
-
-    // Fill out the new grid
-    for (size_t new_col_idx = 0; new_col_idx < height; new_col_idx++)
-    {
-        new_grid->at(new_col_idx) = new std::vector<bool>(width);
-        for (size_t new_row_idx = 0; new_row_idx < width; new_row_idx++)
-        {
-            new_grid->at(new_col_idx)->at(new_row_idx) = grid->at(new_row_idx)->at(height - 1 - new_col_idx);
-        }
-    }
-
-    // Delete the old grid
-    for (size_t col_idx = 0; col_idx < width; col_idx++)
+    countStat(StatCounter::Rotations);
+    if (orientations != nullptr)
     {
-        delete grid->at(col_idx);
+        *this = orientations->pieces[kCounterClockwise[orientation]];
+        return;
     }
-    delete grid;
-    grid = nullptr;
-
-    // Swap width and height
-    size_t temp_val = width;
-    width = height;
-    height = temp_val;
 
-    // Save the new grid
-    grid = new_grid;
+    // new(col, row) = old(row, height - 1 - col), which is a transpose followed by a horizontal flip
+    cells = transposePiece(cells);
+    std::swap(width, height);
+    cells = mirrorPieceRows(cells) >> (kMaxPieceSize - width);
+    orientation = kCounterClockwise[orientation];
+    computeProfile();
 }
 
 void TetrisPiece::rotateClockwise()
 {
-    // Create new grid
-    std::vector<std::vector<bool> *> *new_grid = new std::vector<std::vector<bool> *>(height);
-
-    // Fill out the new grid
-    for (size_t new_col_idx = 0; new_col_idx < height; new_col_idx++)
+    countStat(StatCounter::Rotations);
+    if (orientations != nullptr)
     {
-        new_grid->at(new_col_idx) = new std::vector<bool>(width);
-        for (size_t new_row_idx = 0; new_row_idx < width; new_row_idx++)
-        {
-            new_grid->at(new_col_idx)->at(new_row_idx) = grid->at(width - 1 - new_row_idx)->at(new_col_idx);
-        }
+        *this = orientations->pieces[kClockwise[orientation]];
+        return;
     }
 
-    // Delete the old grid
-    for (size_t col_idx = 0; col_idx < width; col_idx++)
+    // new(col, row) = old(width - 1 - row, col), which is a transpose followed by a vertical flip
+    cells = transposePiece(cells);
+    std::swap(width, height);
+    cells = mirrorPieceColumns(cells) >> ((kMaxPieceSize - height) * kMaxPieceSize);
+    orientation = kClockwise[orientation];
+    computeProfile();
+}
+
+void TetrisPiece::rotate180()
+{
+    countStat(StatCounter::Rotations);
+    if (orientations != nullptr)
     {
-        delete grid->at(col_idx);
+        *this = orientations->pieces[kHalfTurn[orientation]];
+        return;
     }
-    delete grid;
-    grid = nullptr;
-
-    // Swap width and height
-    size_t temp_val = width;
-    width = height;
-    height = temp_val;
 
-    // Save the new grid
-    grid = new_grid;
+    cells = mirrorPieceRows(cells) >> (kMaxPieceSize - width);
+    cells = mirrorPieceColumns(cells) >> ((kMaxPieceSize - height) * kMaxPieceSize);
+    orientation = kHalfTurn[orientation];
+    computeProfile();
 }
 
-void TetrisPiece::rotate180()
+void TetrisPiece::setOrientation(uint8_t target)
 {
-    // Swap opposite values
-    size_t required_swaps = (width * height) / 2;
-    size_t swaps = 0;
-    for (size_t new_col_idx = 0; new_col_idx < width; new_col_idx++)
+    if (target >= kOrientationCount)
     {
-        for (size_t new_row_idx = 0; new_row_idx < height; new_row_idx++)
-        {
-            bool temp_val = grid->at(new_col_idx)->at(new_row_idx);
-            grid->at(new_col_idx)->at(new_row_idx) = grid->at(width - 1 - new_col_idx)->at(height - 1 - new_row_idx);
-            grid->at(width - 1 - new_col_idx)->at(height - 1 - new_row_idx) = temp_val;
+        throw std::out_of_range("Orientation index out of range");
+    }
+    countStat(StatCounter::Rotations);
 
-            // Early return to avoid un-doing swaps
-            ++swaps;
-            if (swaps >= required_swaps)
-            {
-                return;
-            }
+    if (orientations != nullptr)
+    {
+        *this = orientations->pieces[target];
+        return;
+    }
+
+    // Return to the base shape, then apply the target orientation from there
+    for (uint8_t transform : {kInverse[orientation], target})
+    {
+        if (transform & 4)
+        {
+            flipHorizontal();
+        }
+        for (uint8_t turn = 0; turn < (transform & 3); turn++)
+        {
+            rotateClockwise();
         }
     }
 }
 
 size_t TetrisPiece::lowestBlockInColumn(size_t col_idx) const
 {
-    const std::vector<bool> &column = *(grid->at(col_idx));
-    for (size_t row_idx = 0; row_idx < height; row_idx++)
+    if (col_idx >= width)
     {
-        if (column.at(row_idx))
-        {
-            return row_idx;
-        }
+        throw std::out_of_range("Column index out of range");
     }
 
-    // No blocks present in current column, return largest possible value
-    return std::numeric_limits<size_t>::max();
-};
+    if (skirt[col_idx] == kNoBlock)
+    {
+        // No blocks present in current column, return largest possible value
+        return std::numeric_limits<size_t>::max();
+    }
+    return skirt[col_idx];
+}
 
 std::ostream &operator<<(std::ostream &outs, const TetrisPiece &piece)
 {
@@ -204,7 +201,7 @@ std::ostream &operator<<(std::ostream &outs, const TetrisPiece &piece)
         outs << '|';
         for (size_t col_idx = 0; col_idx < piece.width; col_idx++)
         {
-            if (piece.grid->at(col_idx)->at(row_idx))
+            if (piece.at(col_idx, row_idx))
             {
                 outs << 'X';
             }
@@ -218,36 +215,3 @@ std::ostream &operator<<(std::ostream &outs, const TetrisPiece &piece)
     outs << horizontal_bar;
     return outs;
 }
-
-TetrisPiece TetrisPiece::createQPiece()
-{
-    return TetrisPiece{{{true, true}, {true, true}}};
-}
-
-TetrisPiece TetrisPiece::createZPiece()
-{
-    return TetrisPiece{{{false, true}, {true, true}, {true, false}}};
-}
-
-TetrisPiece TetrisPiece::createTPiece()
-{
-    return TetrisPiece{{{false, true}, {true, true}, {false, true}}};
-}
-
-TetrisPiece TetrisPiece::createIPiece()
-{
-    return TetrisPiece{{{true}, {true}, {true}, {true}}};
-}
-
-TetrisPiece TetrisPiece::createLPiece()
-{
-    return TetrisPiece{{{true, true, true}, {true, false, false}}};
-}
-
-const std::map<char, std::function<TetrisPiece()>> TetrisPiece::pieceFactories = {
-    {'Q', TetrisPiece::createQPiece},
-    {'Z', TetrisPiece::createZPiece},
-    {'T', TetrisPiece::createTPiece},
-    {'I', TetrisPiece::createIPiece},
-    {'L', TetrisPiece::createLPiece},
-};
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include "tetris/piece_set.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+    // Columns zero and kMaxPieceSize - 1 of a piece mask, which must not wrap into the neighbouring row when shifting sideways
+    constexpr uint64_t kFirstColumn = kPieceColumnMask;
+    constexpr uint64_t kLastColumn = kPieceColumnMask << (kMaxPieceSize - 1);
+
+    // Whether every filled cell can be reached from every other through shared edges
+    bool isConnected(uint64_t cells)
+    {
+        uint64_t reached = cells & -cells;
+        while (true)
+        {
+            uint64_t grown = reached | ((reached << 1) & ~kFirstColumn) | ((reached >> 1) & ~kLastColumn) |
+                             (reached << kMaxPieceSize) | (reached >> kMaxPieceSize);
+            grown &= cells;
+            if (grown == reached)
+            {
+                return reached == cells;
+            }
+            reached = grown;
+        }
+    }
+
+    std::string trim(const std::string &line)
+    {
+        auto is_space = [](unsigned char c)
+        { return std::isspace(c); };
+        auto first = std::find_if_not(line.begin(), line.end(), is_space);
+        auto last = std::find_if_not(line.rbegin(), line.rend(), is_space).base();
+        return first < last ? std::string(first, last) : std::string();
+    }
+
+    // Build a piece from rows listed top to bottom
+    TetrisPiece pieceFromRows(char name, const std::vector<std::string> &rows)
+    {
+        if (rows.empty())
+        {
+            throw std::invalid_argument(std::string("Piece ") + name + " has no rows");
+        }
+        if (rows.size() > kMaxPieceSize || rows[0].size() > kMaxPieceSize)
+        {
+            throw std::invalid_argument(std::string("Piece ") + name + " is larger than kMaxPieceSize");
+        }
+
+        uint64_t cells = 0;
+        for (size_t line_idx = 0; line_idx < rows.size(); line_idx++)
+        {
+            if (rows[line_idx].size() != rows[0].size())
+            {
+                throw std::invalid_argument(std::string("Rows of piece ") + name + " have different lengths");
+            }
+            size_t row_idx = rows.size() - 1 - line_idx;
+            for (size_t col_idx = 0; col_idx < rows[line_idx].size(); col_idx++)
+            {
+                cells |= uint64_t{rows[line_idx][col_idx] == 'X'} << (row_idx * kMaxPieceSize + col_idx);
+            }
+        }
+        return TetrisPiece(cells, static_cast<uint8_t>(rows[0].size()), static_cast<uint8_t>(rows.size()));
+    }
+}
+
+const PieceSet &PieceSet::standard()
+{
+    static const PieceSet set = []
+    {
+        PieceSet standard_set;
+        for (uint8_t id = 0; id < kStandardPieceCount; id++)
+        {
+            standard_set.names.push_back(kPieceNames[id]);
+            standard_set.tables.push_back(&kStandardPieces[id]);
+        }
+        return standard_set;
+    }();
+    return set;
+}
+
+PieceSet PieceSet::parse(std::istream &in)
+{
+    PieceSet set;
+    std::string line;
+    size_t line_number = 0;
+    char name = 0;
+    bool in_piece = false;
+    std::vector<std::string> rows;
+
+    auto finish_piece = [&]
+    {
+        if (in_piece)
+        {
+            set.add(name, pieceFromRows(name, rows));
+        }
+        in_piece = false;
+        rows.clear();
+    };
+
+    while (std::getline(in, line))
+    {
+        line_number++;
+        line = trim(line);
+        if (line.empty() || line[0] == '#')
+        {
+            // A blank line ends the rows of a piece, a comment does not
+            if (line.empty() && in_piece && !rows.empty())
+            {
+                finish_piece();
+            }
+            continue;
+        }
+
+        if (line.rfind("piece", 0) == 0)
+        {
+            finish_piece();
+            std::string piece_name = trim(line.substr(5));
+            if (piece_name.size() != 1 || !std::isgraph(static_cast<unsigned char>(piece_name[0])))
+            {
+                throw std::invalid_argument("Line " + std::to_string(line_number) + ": piece names must be a single visible character");
+            }
+            name = piece_name[0];
+            in_piece = true;
+            continue;
+        }
+
+        if (!in_piece)
+        {
+            throw std::invalid_argument("Line " + std::to_string(line_number) + ": expected a piece header");
+        }
+        if (line.find_first_not_of("X_.") != std::string::npos)
+        {
+            throw std::invalid_argument("Line " + std::to_string(line_number) + ": rows may only hold X, _ and .");
+        }
+        rows.push_back(line);
+    }
+    finish_piece();
+    return set;
+}
+
+PieceSet PieceSet::load(const std::string &path)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        throw std::runtime_error("Failed to open piece set " + path);
+    }
+    return parse(in);
+}
+
+size_t PieceSet::add(char name, const TetrisPiece &shape)
+{
+    std::string label = std::string("Piece ") + name;
+    if (std::find(names.begin(), names.end(), name) != names.end())
+    {
+        throw std::invalid_argument(label + " is defined twice");
+    }
+
+    uint64_t top_row = uint64_t{0xFF} << ((shape.height - 1) * kMaxPieceSize);
+    uint64_t right_column = kFirstColumn << (shape.width - 1);
+    if (!(shape.cells & 0xFF) || !(shape.cells & top_row) || !(shape.cells & kFirstColumn) || !(shape.cells & right_column))
+    {
+        throw std::invalid_argument(label + " has an empty row or column on its border");
+    }
+    if (!isConnected(shape.cells))
+    {
+        throw std::invalid_argument(label + " is not connected");
+    }
+
+    // Comparing against every orientation of the existing pieces also catches rotations and reflections of the new one
+    for (size_t piece_idx = 0; piece_idx < tables.size(); piece_idx++)
+    {
+        for (const TetrisPiece &existing : tables[piece_idx]->pieces)
+        {
+            if (existing == shape)
+            {
+                throw std::invalid_argument(label + " is an orientation of piece " + names[piece_idx]);
+            }
+        }
+    }
+
+    owned_tables.push_back(std::make_unique<PieceOrientationTable>(TetrisPiece(shape.cells, shape.width, shape.height)));
+    tables.push_back(owned_tables.back().get());
+    names.push_back(name);
+    return tables.size() - 1;
+}
+
+size_t PieceSet::indexOf(char name) const
+{
+    auto found = std::find(names.begin(), names.end(), name);
+    if (found == names.end())
+    {
+        throw std::out_of_range(std::string("No piece named ") + name);
+    }
+    return static_cast<size_t>(found - names.begin());
+}
+
+size_t PieceSet::indexOf(const TetrisPiece &piece) const
+{
+    auto found = std::find(tables.begin(), tables.end(), piece.orientations);
+    return found == tables.end() ? npos : static_cast<size_t>(found - tables.begin());
+}
@@ -0,0 +1,61 @@
+#include "tetris/placement.h"
+#include <stdexcept>
+#include <array>
+
+namespace
+{
+    // Append the placement of every column of one orientation, returning the new count
+    size_t appendColumns(const TetrisBoard &board, const TetrisPiece &piece, std::span<Placement> out, size_t count)
+    {
+        for (int col_offset = 0; col_offset + piece.width <= TetrisBoard::width; col_offset++)
+        {
+            int row_offset = board.landingRow(piece, col_offset);
+            if (row_offset + piece.height <= TetrisBoard::height)
+            {
+                out[count++] = Placement{piece.orientation, static_cast<uint8_t>(col_offset), static_cast<uint8_t>(row_offset)};
+            }
+        }
+        return count;
+    }
+}
+
+size_t enumeratePlacements(const TetrisBoard &board, const TetrisPiece &piece, std::span<Placement> out)
+{
+    if (out.size() < kMaxPlacements)
+    {
+        throw std::invalid_argument("Placement buffer must hold at least kMaxPlacements entries");
+    }
+
+    size_t count = 0;
+    if (piece.orientations != nullptr)
+    {
+        // The table already knows which orientations are distinct
+        const PieceOrientationTable &table = *piece.orientations;
+        for (uint8_t distinct_idx = 0; distinct_idx < table.distinct_count; distinct_idx++)
+        {
+            count = appendColumns(board, table.pieces[table.distinct[distinct_idx]], out, count);
+        }
+        return count;
+    }
+
+    // Without a table, build each orientation and skip shapes already seen
+    std::array<TetrisPiece, kOrientationCount> seen{piece, piece, piece, piece, piece, piece, piece, piece};
+    size_t seen_count = 0;
+    for (uint8_t orientation_idx = 0; orientation_idx < kOrientationCount; orientation_idx++)
+    {
+        TetrisPiece oriented = piece;
+        oriented.setOrientation(orientation_idx);
+        bool duplicate = false;
+        for (size_t seen_idx = 0; seen_idx < seen_count; seen_idx++)
+        {
+            duplicate |= seen[seen_idx] == oriented;
+        }
+        if (duplicate)
+        {
+            continue;
+        }
+        seen[seen_count++] = oriented;
+        count = appendColumns(board, oriented, out, count);
+    }
+    return count;
+}
@@ -0,0 +1,284 @@
+#include "tetris/reachability.h"
+#include <bit>
+#include <stdexcept>
+
+namespace
+{
+    constexpr int kWidth = TetrisBoard::width;
+    constexpr int kHeight = TetrisBoard::height;
+
+    bool hasCell(const PieceShape &shape, int col_idx, int row_idx)
+    {
+        return col_idx >= 0 && row_idx >= 0 && col_idx < shape.width && row_idx < shape.height &&
+               ((shape.cells >> (row_idx * kMaxPieceSize + col_idx)) & 1);
+    }
+
+    // Number of filled neighbours of a cell of a piece
+    int pieceNeighbours(const PieceShape &shape, int col_idx, int row_idx)
+    {
+        return hasCell(shape, col_idx - 1, row_idx) + hasCell(shape, col_idx + 1, row_idx) + hasCell(shape, col_idx, row_idx - 1) +
+               hasCell(shape, col_idx, row_idx + 1);
+    }
+
+    // Cells beside and below the board count as filled for spin corners, and cells above it as empty
+    bool cornerFilled(const TetrisBoard &board, int col_idx, int row_idx)
+    {
+        if (col_idx < 0 || col_idx >= kWidth || row_idx < 0)
+        {
+            return true;
+        }
+        return row_idx < kHeight && board.at(col_idx, row_idx);
+    }
+}
+
+ReachabilitySearch::ReachabilitySearch(std::span<const Kick> kicks)
+    : kicks(kicks), rotations{}, orientations{}, canonical{}, can_spin(false), open{}, open_rows{}, arrived{}, reported{}, queue{}, parent{},
+      parent_input{}, distance{}, first_arrival{}, spawn_state(0)
+{
+}
+
+void ReachabilitySearch::prepare(const TetrisBoard &board, const TetrisPiece &piece)
+{
+    for (int rotation = 0; rotation < kRotations; rotation++)
+    {
+        // Clockwise turns keep the mirror bit and advance the turn count (see kOrientationCount)
+        uint8_t orientation = static_cast<uint8_t>((piece.orientation & 4) | ((piece.orientation + rotation) & 3));
+        orientations[rotation] = orientation;
+        rotations[rotation] = piece.orientations != nullptr ? piece.orientations->pieces[orientation].shape()
+                                                            : orientShape(piece.shape(), static_cast<uint8_t>(rotation));
+        canonical[rotation] = static_cast<uint8_t>(rotation);
+        for (int first = 0; first < rotation; first++)
+        {
+            if (rotations[first] == rotations[rotation])
+            {
+                canonical[rotation] = static_cast<uint8_t>(first);
+                break;
+            }
+        }
+
+        // A column is blocked if any cell of the piece would land on a filled cell, so OR together the board rows shifted right by
+        // the column of every piece cell
+        const PieceShape &shape = rotations[rotation];
+        open_rows[rotation] = {};
+        Row columns_on_board = static_cast<Row>((Row{1} << (kWidth - shape.width + 1)) - 1);
+        for (int row_idx = 0; row_idx < kHeight; row_idx++)
+        {
+            if (row_idx + shape.height > kHeight)
+            {
+                open[rotation][row_idx] = 0;
+                continue;
+            }
+            Row blocked = 0;
+            for (int piece_row = 0; piece_row < shape.height; piece_row++)
+            {
+                Row board_row = board.row(row_idx + piece_row);
+                for (uint8_t bits = static_cast<uint8_t>(shape.cells >> (piece_row * kMaxPieceSize)); bits != 0; bits &= bits - 1)
+                {
+                    blocked |= static_cast<Row>(board_row >> std::countr_zero(bits));
+                }
+            }
+            open[rotation][row_idx] = static_cast<Row>(~blocked & columns_on_board);
+            for (Row columns = open[rotation][row_idx]; columns != 0; columns &= columns - 1)
+            {
+                open_rows[rotation][std::countr_zero(columns)] |= TetrisBoard::RowMask{1} << row_idx;
+            }
+        }
+    }
+
+    // A T is the only four cell piece with a cell touching the other three
+    can_spin = false;
+    const PieceShape &shape = rotations[0];
+    if (std::popcount(shape.cells) == 4)
+    {
+        for (int col_idx = 0; col_idx < shape.width; col_idx++)
+        {
+            for (int row_idx = 0; row_idx < shape.height; row_idx++)
+            {
+                can_spin |= hasCell(shape, col_idx, row_idx) && pieceNeighbours(shape, col_idx, row_idx) == 3;
+            }
+        }
+    }
+}
+
+SpinType ReachabilitySearch::spinType(const TetrisBoard &board, int rotation, int column, int row) const
+{
+    const PieceShape &shape = rotations[rotation];
+    for (int col_idx = 0; col_idx < shape.width; col_idx++)
+    {
+        for (int row_idx = 0; row_idx < shape.height; row_idx++)
+        {
+            if (!hasCell(shape, col_idx, row_idx) || pieceNeighbours(shape, col_idx, row_idx) != 3)
+            {
+                continue;
+            }
+
+            // The T points away from the side of its centre with no neighbour
+            int point_col = hasCell(shape, col_idx + 1, row_idx) - hasCell(shape, col_idx - 1, row_idx);
+            int point_row = hasCell(shape, col_idx, row_idx + 1) - hasCell(shape, col_idx, row_idx - 1);
+            int centre_col = column + col_idx;
+            int centre_row = row + row_idx;
+            int front = 0;
+            int back = 0;
+            for (int side : {-1, 1})
+            {
+                // The corners beside the point, one on each side of it
+                int side_col = point_row != 0 ? side : 0;
+                int side_row = point_col != 0 ? side : 0;
+                front += cornerFilled(board, centre_col + point_col + side_col, centre_row + point_row + side_row);
+                back += cornerFilled(board, centre_col - point_col + side_col, centre_row - point_row + side_row);
+            }
+            if (front + back < 3)
+            {
+                return SpinType::None;
+            }
+            return front == 2 ? SpinType::Full : SpinType::Mini;
+        }
+    }
+    return SpinType::None;
+}
+
+size_t ReachabilitySearch::search(const TetrisBoard &board, const TetrisPiece &piece, std::span<ReachablePlacement> out)
+{
+    if (out.size() < kMaxReachable)
+    {
+        throw std::invalid_argument("Placement buffer must hold at least kMaxReachable entries");
+    }
+    prepare(board, piece);
+    arrived = {};
+    reported = {};
+
+    int spawn_column = (kWidth - rotations[0].width) / 2;
+    int spawn_row = kHeight - rotations[0].height;
+    if (!fits(0, spawn_column, spawn_row))
+    {
+        return 0;
+    }
+    size_t head = 0;
+    size_t tail = 0;
+    size_t count = 0;
+
+    // Report the hard drop from a state just arrived at. Arrivals happen in order of distance, so placements come out in order of
+    // their shortest input sequence. Only a piece which rotated into its resting place, without moving since, can have spun.
+    auto report = [&](uint16_t state, int kind)
+    {
+        int column = state % kWidth;
+        int row = (state / kWidth) % kHeight;
+        int rotation = state / (kWidth * kHeight);
+        TetrisBoard::RowMask blocked_below = ~open_rows[rotation][column] & ((TetrisBoard::RowMask{1} << row) - 1);
+        int rest = blocked_below != 0 ? std::bit_width(blocked_below) : 0;
+        SpinType spin = SpinType::None;
+        if (can_spin && kind == kRotated && rest == row)
+        {
+            spin = spinType(board, rotation, column, row);
+        }
+        int shape_rotation = canonical[rotation];
+        Row &seen = reported[static_cast<size_t>(spin)][shape_rotation][rest];
+        if (!((seen >> column) & 1))
+        {
+            seen |= Row{1} << column;
+            out[count++] = ReachablePlacement{Placement{orientations[shape_rotation], static_cast<uint8_t>(column), static_cast<uint8_t>(rest)},
+                                              spin, static_cast<uint16_t>(distance[kind][state] + 1), state};
+        }
+    };
+
+    // Record the first arrival of its kind at a state from the one being expanded, queueing the state if it is new
+    auto visit = [&](uint16_t from, int rotation, int column, int row, Input input)
+    {
+        int kind = input == Input::RotateClockwise || input == Input::RotateCounterClockwise ? kRotated : kMoved;
+        if ((arrived[kind][rotation][row] >> column) & 1)
+        {
+            return;
+        }
+        bool is_new = !((arrived[kind ^ 1][rotation][row] >> column) & 1);
+        arrived[kind][rotation][row] |= Row{1} << column;
+        uint16_t state = stateId(rotation, column, row);
+        parent[kind][state] = from;
+        parent_input[kind][state] = input;
+        distance[kind][state] = static_cast<uint16_t>(distance[first_arrival[from]][from] + 1);
+        if (is_new)
+        {
+            first_arrival[state] = static_cast<uint8_t>(kind);
+            queue[tail++] = state;
+        }
+        report(state, kind);
+    };
+
+    spawn_state = stateId(0, spawn_column, spawn_row);
+    arrived[kMoved][0][spawn_row] |= Row{1} << spawn_column;
+    distance[kMoved][spawn_state] = 0;
+    first_arrival[spawn_state] = kMoved;
+    queue[tail++] = spawn_state;
+    report(spawn_state, kMoved);
+
+    while (head < tail)
+    {
+        uint16_t state = queue[head++];
+        int column = state % kWidth;
+        int row = (state / kWidth) % kHeight;
+        int rotation = state / (kWidth * kHeight);
+
+        if (fits(rotation, column - 1, row))
+        {
+            visit(state, rotation, column - 1, row, Input::Left);
+        }
+        if (fits(rotation, column + 1, row))
+        {
+            visit(state, rotation, column + 1, row, Input::Right);
+        }
+        if (fits(rotation, column, row - 1))
+        {
+            visit(state, rotation, column, row - 1, Input::SoftDrop);
+        }
+
+        // Rotate about the centre of the bounding box, then take the first kick that fits
+        const PieceShape &shape = rotations[rotation];
+        for (int turn : {1, 3})
+        {
+            int turned = (rotation + turn) & 3;
+            const PieceShape &turned_shape = rotations[turned];
+            int turned_column = column + (shape.width - turned_shape.width) / 2;
+            int turned_row = row + (shape.height - turned_shape.height) / 2;
+            for (const Kick &kick : kicks)
+            {
+                if (fits(turned, turned_column + kick.columns, turned_row + kick.rows))
+                {
+                    visit(state, turned, turned_column + kick.columns, turned_row + kick.rows,
+                          turn == 1 ? Input::RotateClockwise : Input::RotateCounterClockwise);
+                    break;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+size_t ReachabilitySearch::inputs(const ReachablePlacement &placement, std::span<Input> out) const
+{
+    if (out.size() < placement.input_count)
+    {
+        throw std::invalid_argument("Input buffer is too small for the placement");
+    }
+    // A spin needs the rotation arrival. Otherwise take whichever arrival the placement was reported from: the shift or drop arrival if
+    // it is that short, as a rotation arrival may have spun.
+    uint16_t state = placement.origin;
+    int column = state % kWidth;
+    int row = (state / kWidth) % kHeight;
+    int rotation = state / (kWidth * kHeight);
+    int kind = kRotated;
+    if (placement.spin == SpinType::None && ((arrived[kMoved][rotation][row] >> column) & 1) &&
+        distance[kMoved][state] + 1 == placement.input_count)
+    {
+        kind = kMoved;
+    }
+
+    // Every earlier step follows the first, and so shortest, arrival at its state
+    size_t count = distance[kind][state];
+    out[count] = Input::HardDrop;
+    while (state != spawn_state)
+    {
+        out[--count] = parent_input[kind][state];
+        state = parent[kind][state];
+        kind = first_arrival[state];
+    }
+    return placement.input_count;
+}
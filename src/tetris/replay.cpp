@@ -0,0 +1,333 @@
+#include "tetris/replay.h"
+#include "tetris/zobrist.h"
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    // File layout, all integers little endian:
+    //   header:  magic (4) | version (1) | code size (1) | board width (1) | board height (1) | block size (4) | fingerprint (8) | reserved (4)
+    //   blocks:  board snapshot (height rows of 2 bytes) | one code per move
+    //   index:   file offset of each block (8 each)
+    //   footer:  index offset (8) | move count (8) | block count (8) | magic (4) | reserved (4)
+    constexpr std::array<uint8_t, 4> kHeaderMagic = {'T', 'R', 'P', 'L'};
+    constexpr std::array<uint8_t, 4> kFooterMagic = {'T', 'R', 'P', 'E'};
+    constexpr uint8_t kVersion = 1;
+    constexpr size_t kHeaderSize = 24;
+    constexpr size_t kFooterSize = 32;
+    constexpr size_t kSnapshotSize = TetrisBoard::height * sizeof(TetrisBoard::Row);
+
+    template <typename T>
+    void storeLittleEndian(uint8_t *bytes, T value)
+    {
+        for (size_t byte_idx = 0; byte_idx < sizeof(T); byte_idx++)
+        {
+            bytes[byte_idx] = static_cast<uint8_t>(value >> (8 * byte_idx));
+        }
+    }
+
+    template <typename T>
+    T loadLittleEndian(const uint8_t *bytes)
+    {
+        T value = 0;
+        for (size_t byte_idx = 0; byte_idx < sizeof(T); byte_idx++)
+        {
+            value |= static_cast<T>(bytes[byte_idx]) << (8 * byte_idx);
+        }
+        return value;
+    }
+}
+
+ReplayCodec::ReplayCodec()
+{
+    first_codes.fill(kNoCode);
+    for (uint8_t piece_id = 0; piece_id < kStandardPieceCount; piece_id++)
+    {
+        const PieceOrientationTable &table = kStandardPieces[piece_id];
+        for (uint8_t distinct_idx = 0; distinct_idx < table.distinct_count; distinct_idx++)
+        {
+            const TetrisPiece &oriented = table.pieces[table.distinct[distinct_idx]];
+            first_codes[piece_id * kOrientationCount + oriented.orientation] = static_cast<uint16_t>(moves.size());
+            for (int col_idx = 0; col_idx + oriented.width <= TetrisBoard::width; col_idx++)
+            {
+                moves.push_back(ReplayMove{static_cast<PieceId>(piece_id), oriented.orientation, static_cast<uint8_t>(col_idx)});
+            }
+        }
+    }
+}
+
+uint64_t ReplayCodec::fingerprint() const
+{
+    uint64_t hash = mixBits(TetrisBoard::width);
+    for (const PieceOrientationTable &table : kStandardPieces)
+    {
+        const TetrisPiece &piece = table.pieces[0];
+        hash = mixBits(hash ^ piece.cells ^ (uint64_t{piece.width} << 56) ^ (uint64_t{piece.height} << 60));
+    }
+    return hash;
+}
+
+uint16_t ReplayCodec::encode(const ReplayMove &move) const
+{
+    if (move.piece >= kStandardPieceCount || move.orientation >= kOrientationCount)
+    {
+        throw std::invalid_argument("Replay move has an invalid piece or orientation");
+    }
+    const PieceOrientationTable &table = kStandardPieces[move.piece];
+    uint8_t orientation = table.canonical[move.orientation];
+    if (move.column + table.pieces[orientation].width > TetrisBoard::width)
+    {
+        throw std::invalid_argument("Replay move column does not fit the piece");
+    }
+    return first_codes[move.piece * kOrientationCount + orientation] + move.column;
+}
+
+const ReplayMove &ReplayCodec::decode(uint16_t code) const
+{
+    if (code >= moves.size())
+    {
+        throw std::invalid_argument("Invalid replay move code");
+    }
+    return moves[code];
+}
+
+ReplayWriter::ReplayWriter(std::ostream &out, uint32_t block_size)
+    : out(out), block_size(block_size), move_count(0), bytes_written(0), finished(false)
+{
+    if (block_size == 0)
+    {
+        throw std::invalid_argument("Replay block size must be greater than zero");
+    }
+
+    std::array<uint8_t, kHeaderSize> header{};
+    std::memcpy(header.data(), kHeaderMagic.data(), kHeaderMagic.size());
+    header[4] = kVersion;
+    header[5] = static_cast<uint8_t>(codec.codeSize());
+    header[6] = TetrisBoard::width;
+    header[7] = TetrisBoard::height;
+    storeLittleEndian<uint32_t>(&header[8], block_size);
+    storeLittleEndian<uint64_t>(&header[12], codec.fingerprint());
+    writeBytes(header.data(), header.size());
+}
+
+ReplayWriter::~ReplayWriter()
+{
+    try
+    {
+        finish();
+    }
+    catch (...)
+    {
+        // Destructors must not throw. Call finish explicitly to see write errors.
+    }
+}
+
+void ReplayWriter::writeBytes(const void *bytes, size_t count)
+{
+    out.write(static_cast<const char *>(bytes), static_cast<std::streamsize>(count));
+    if (!out)
+    {
+        throw std::runtime_error("Failed to write replay");
+    }
+    bytes_written += count;
+}
+
+int ReplayWriter::record(const TetrisPiece &piece, const Placement &placement)
+{
+    if (finished)
+    {
+        throw std::logic_error("Replay is already finished");
+    }
+
+    PieceId piece_id = standardPieceId(piece);
+    if (piece_id == kStandardPieceCount)
+    {
+        throw std::invalid_argument("Only standard pieces can be recorded in a replay");
+    }
+    ReplayMove move{piece_id, placement.orientation, placement.column};
+    uint16_t code = codec.encode(move);
+    TetrisPiece oriented = piece;
+    oriented.setOrientation(placement.orientation);
+
+    // Apply the move to a copy first, so a move that tops out leaves nothing half written
+    TetrisBoard next = board;
+    int cleared = next.addPiece(oriented, placement.column);
+
+    // Start a new block with a snapshot of the board before its first move
+    if (move_count % block_size == 0)
+    {
+        block_offsets.push_back(bytes_written);
+        std::array<uint8_t, kSnapshotSize> snapshot;
+        for (int row_idx = 0; row_idx < TetrisBoard::height; row_idx++)
+        {
+            storeLittleEndian<TetrisBoard::Row>(&snapshot[row_idx * sizeof(TetrisBoard::Row)], board.row(row_idx));
+        }
+        writeBytes(snapshot.data(), snapshot.size());
+    }
+
+    std::array<uint8_t, 2> code_bytes;
+    storeLittleEndian<uint16_t>(code_bytes.data(), code);
+    writeBytes(code_bytes.data(), codec.codeSize());
+    board = next;
+    move_count++;
+    return cleared;
+}
+
+void ReplayWriter::finish()
+{
+    if (finished)
+    {
+        return;
+    }
+    finished = true;
+
+    uint64_t index_offset = bytes_written;
+    for (uint64_t block_offset : block_offsets)
+    {
+        std::array<uint8_t, 8> entry;
+        storeLittleEndian<uint64_t>(entry.data(), block_offset);
+        writeBytes(entry.data(), entry.size());
+    }
+
+    std::array<uint8_t, kFooterSize> footer{};
+    storeLittleEndian<uint64_t>(&footer[0], index_offset);
+    storeLittleEndian<uint64_t>(&footer[8], move_count);
+    storeLittleEndian<uint64_t>(&footer[16], block_offsets.size());
+    std::memcpy(&footer[24], kFooterMagic.data(), kFooterMagic.size());
+    writeBytes(footer.data(), footer.size());
+    out.flush();
+}
+
+ReplayReader::ReplayReader(const std::string &path)
+    : data(nullptr), size(0)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Failed to open replay " + path);
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size < static_cast<off_t>(kHeaderSize + kFooterSize))
+    {
+        close(fd);
+        throw std::runtime_error("Replay " + path + " is too small");
+    }
+    size = static_cast<size_t>(file_stat.st_size);
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        throw std::runtime_error("Failed to map replay " + path);
+    }
+    data = static_cast<const uint8_t *>(mapping);
+
+    try
+    {
+        const uint8_t *header = at(0, kHeaderSize);
+        if (std::memcmp(header, kHeaderMagic.data(), kHeaderMagic.size()) != 0 || header[4] != kVersion)
+        {
+            throw std::runtime_error("Not a replay file, or an unsupported version");
+        }
+        if (header[5] != codec.codeSize() || header[6] != TetrisBoard::width || header[7] != TetrisBoard::height ||
+            loadLittleEndian<uint64_t>(&header[12]) != codec.fingerprint())
+        {
+            throw std::runtime_error("Replay was recorded with a different piece set or board size");
+        }
+        block_size = loadLittleEndian<uint32_t>(&header[8]);
+
+        const uint8_t *footer = at(size - kFooterSize, kFooterSize);
+        if (std::memcmp(&footer[24], kFooterMagic.data(), kFooterMagic.size()) != 0)
+        {
+            throw std::runtime_error("Replay is truncated or was not finished");
+        }
+        index_offset = loadLittleEndian<uint64_t>(&footer[0]);
+        move_count = loadLittleEndian<uint64_t>(&footer[8]);
+        block_count = loadLittleEndian<uint64_t>(&footer[16]);
+        if (block_size == 0 || block_count != (move_count + block_size - 1) / block_size)
+        {
+            throw std::runtime_error("Replay index does not match its move count");
+        }
+        at(index_offset, block_count * 8);
+    }
+    catch (...)
+    {
+        munmap(const_cast<uint8_t *>(data), size);
+        throw;
+    }
+}
+
+ReplayReader::~ReplayReader()
+{
+    munmap(const_cast<uint8_t *>(data), size);
+}
+
+const uint8_t *ReplayReader::at(uint64_t offset, uint64_t count) const
+{
+    if (offset > size || count > size - offset)
+    {
+        throw std::runtime_error("Replay is truncated");
+    }
+    return data + offset;
+}
+
+uint64_t ReplayReader::blockMovesOffset(uint64_t block_idx) const
+{
+    return loadLittleEndian<uint64_t>(at(index_offset + block_idx * 8, 8)) + kSnapshotSize;
+}
+
+ReplayMove ReplayReader::move(uint64_t move_idx) const
+{
+    if (move_idx >= move_count)
+    {
+        throw std::out_of_range("Replay move index out of range");
+    }
+    uint64_t block_idx = move_idx / block_size;
+    uint64_t offset = blockMovesOffset(block_idx) + (move_idx % block_size) * codec.codeSize();
+    const uint8_t *code_bytes = at(offset, codec.codeSize());
+    uint16_t code = codec.codeSize() == 1 ? code_bytes[0] : loadLittleEndian<uint16_t>(code_bytes);
+    return codec.decode(code);
+}
+
+TetrisPiece ReplayReader::piece(uint64_t move_idx) const
+{
+    ReplayMove recorded = move(move_idx);
+    TetrisPiece placed = standardPiece(recorded.piece);
+    placed.setOrientation(recorded.orientation);
+    return placed;
+}
+
+TetrisBoard ReplayReader::boardBefore(uint64_t move_idx) const
+{
+    if (move_idx > move_count)
+    {
+        throw std::out_of_range("Replay move index out of range");
+    }
+    if (move_count == 0)
+    {
+        return TetrisBoard{};
+    }
+
+    // The final board lies after the last move of the last block
+    uint64_t block_idx = std::min(move_idx / block_size, block_count - 1);
+    const uint8_t *snapshot = at(blockMovesOffset(block_idx) - kSnapshotSize, kSnapshotSize);
+    std::array<TetrisBoard::Row, TetrisBoard::height> rows;
+    for (int row_idx = 0; row_idx < TetrisBoard::height; row_idx++)
+    {
+        rows[row_idx] = loadLittleEndian<TetrisBoard::Row>(&snapshot[row_idx * sizeof(TetrisBoard::Row)]);
+    }
+
+    TetrisBoard board(rows);
+    for (uint64_t replay_idx = block_idx * block_size; replay_idx < move_idx; replay_idx++)
+    {
+        ReplayMove recorded = move(replay_idx);
+        TetrisPiece placed = standardPiece(recorded.piece);
+        placed.setOrientation(recorded.orientation);
+        board.addPiece(placed, recorded.column);
+    }
+    return board;
+}
@@ -0,0 +1,142 @@
+#include "tetris/search.h"
+#include "tetris/arena.h"
+#include <array>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    constexpr double kLostGame = -std::numeric_limits<double>::infinity();
+
+    // Per thread storage for the nodes of the parallel part of the tree. A thread waiting on a node runs other tasks in the meantime,
+    // which may expand nodes of their own, but those always finish first, so the arena is released in stack order.
+    thread_local Arena node_arena;
+}
+
+GameTreeSearch::GameTreeSearch(EvaluationFunction evaluate, ThreadPool &pool, int parallel_plies, TranspositionTable *table)
+    : evaluate(std::move(evaluate)), pool(pool), parallel_plies(parallel_plies), table(table)
+{
+}
+
+uint64_t GameTreeSearch::nodeKey(const TetrisBoard &board, std::span<const TetrisPiece> pieces, int lines_cleared)
+{
+    // Fold the remaining sequence in order, so the same pieces in a different order give a different key
+    uint64_t sequence_key = mixBits(static_cast<uint64_t>(lines_cleared));
+    for (const TetrisPiece &piece : pieces)
+    {
+        sequence_key = mixBits(sequence_key ^ zobristPiece(piece));
+    }
+    return board.hash() ^ sequence_key;
+}
+
+double GameTreeSearch::searchSequential(TetrisBoard &board, std::span<const TetrisPiece> pieces, int lines_cleared) const
+{
+    if (pieces.empty())
+    {
+        return evaluate(board, lines_cleared);
+    }
+
+    uint64_t key = 0;
+    if (table != nullptr)
+    {
+        key = nodeKey(board, pieces, lines_cleared);
+        TranspositionEntry entry;
+        if (table->probe(key, entry) && entry.depth == pieces.size())
+        {
+            return entry.score;
+        }
+    }
+
+    std::array<Placement, kMaxPlacements> placements;
+    size_t count = enumeratePlacements(board, pieces[0], placements);
+    TetrisPiece piece = pieces[0];
+    double best = kLostGame;
+    size_t best_idx = 0;
+    for (size_t placement_idx = 0; placement_idx < count; placement_idx++)
+    {
+        const Placement &placement = placements[placement_idx];
+        piece.setOrientation(placement.orientation);
+        TetrisBoard::UndoRecord undo;
+        int cleared = board.makeMove(piece, placement.column, undo);
+        double score = searchSequential(board, pieces.subspan(1), lines_cleared + cleared);
+        board.unmakeMove(undo);
+        if (score > best)
+        {
+            best = score;
+            best_idx = placement_idx;
+        }
+    }
+
+    if (table != nullptr)
+    {
+        table->store(key, TranspositionEntry{best, static_cast<uint8_t>(pieces.size()), count > 0 ? placements[best_idx] : Placement{}});
+    }
+    return best;
+}
+
+SearchResult GameTreeSearch::searchParallel(const TetrisBoard &board, std::span<const TetrisPiece> pieces, int lines_cleared, int plies_to_split) const
+{
+    // Everything the child tasks share lives in the expanding thread's arena until they have all finished. The tasks capture only a
+    // pointer to it and their index, which keeps each closure small enough to be stored inside std::function without a heap allocation.
+    struct Node
+    {
+        const GameTreeSearch *search;
+        const TetrisBoard *board;
+        std::span<const TetrisPiece> pieces;
+        int lines_cleared;
+        int plies_to_split;
+        std::array<Placement, kMaxPlacements> placements;
+        // Each child writes only its own slot, so the tasks share nothing mutable
+        std::array<double, kMaxPlacements> scores;
+    };
+
+    ArenaScope scope(node_arena);
+    Node *node = node_arena.create<Node>(Node{this, &board, pieces, lines_cleared, plies_to_split, {}, {}});
+    size_t count = enumeratePlacements(board, pieces[0], node->placements);
+
+    TaskGroup group;
+    for (size_t placement_idx = 0; placement_idx < count; placement_idx++)
+    {
+        pool.run(group, [node, placement_idx]
+                 {
+            const Placement &placement = node->placements[placement_idx];
+            TetrisPiece piece = node->pieces[0];
+            piece.setOrientation(placement.orientation);
+            TetrisBoard child = *node->board;
+            int cleared = child.addPiece(piece, placement.column);
+            std::span<const TetrisPiece> rest = node->pieces.subspan(1);
+            if (node->plies_to_split > 1 && rest.size() > 1)
+            {
+                node->scores[placement_idx] = node->search->searchParallel(child, rest, node->lines_cleared + cleared, node->plies_to_split - 1).score;
+            }
+            else
+            {
+                node->scores[placement_idx] = node->search->searchSequential(child, rest, node->lines_cleared + cleared);
+            } });
+    }
+    pool.wait(group);
+
+    SearchResult result{Placement{}, kLostGame, false};
+    for (size_t placement_idx = 0; placement_idx < count; placement_idx++)
+    {
+        if (!result.found || node->scores[placement_idx] > result.score)
+        {
+            result = SearchResult{node->placements[placement_idx], node->scores[placement_idx], true};
+        }
+    }
+    return result;
+}
+
+SearchResult GameTreeSearch::search(const TetrisBoard &board, std::span<const TetrisPiece> pieces) const
+{
+    if (pieces.empty())
+    {
+        throw std::invalid_argument("Search needs at least one piece");
+    }
+    if (table != nullptr)
+    {
+        table->newGeneration();
+    }
+    return searchParallel(board, pieces, 0, std::max(parallel_plies, 1));
+}
@@ -0,0 +1,118 @@
+#include "tetris/simulator.h"
+#include "tetris/zobrist.h"
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+PieceGenerator::PieceGenerator(uint64_t seed, const PieceSet &pieces)
+    : pieces(&pieces), bag(pieces.size()), bag_position(0), rng_state(mixBits(seed))
+{
+    if (pieces.size() == 0)
+    {
+        throw std::invalid_argument("Cannot deal pieces from an empty set");
+    }
+    shuffleBag();
+}
+
+uint64_t PieceGenerator::nextRandom()
+{
+    return mixBits(rng_state++);
+}
+
+void PieceGenerator::shuffleBag()
+{
+    // Fisher-Yates over the piece indices, always starting from the same order so the result only depends on the random stream
+    for (size_t idx = 0; idx < bag.size(); idx++)
+    {
+        bag[idx] = static_cast<uint8_t>(idx);
+    }
+    for (size_t idx = bag.size() - 1; idx > 0; idx--)
+    {
+        std::swap(bag[idx], bag[nextRandom() % (idx + 1)]);
+    }
+    bag_position = 0;
+}
+
+size_t PieceGenerator::nextIndex()
+{
+    if (bag_position == bag.size())
+    {
+        shuffleBag();
+    }
+    return bag[bag_position++];
+}
+
+Policy greedyPolicy(const FeatureWeights &weights)
+{
+    return [weights](const TetrisBoard &board, const TetrisPiece &piece) -> std::optional<Placement>
+    {
+        std::array<Placement, kMaxPlacements> placements;
+        size_t count = enumeratePlacements(board, piece, placements);
+        std::optional<Placement> best;
+        float best_score = -std::numeric_limits<float>::infinity();
+        TetrisPiece oriented = piece;
+        for (size_t placement_idx = 0; placement_idx < count; placement_idx++)
+        {
+            oriented.setOrientation(placements[placement_idx].orientation);
+            TetrisBoard child = board;
+            int cleared = child.addPiece(oriented, placements[placement_idx].column);
+            float score = scoreFeatures(computeFeatures(child, cleared), weights);
+            if (!best || score > best_score)
+            {
+                best = placements[placement_idx];
+                best_score = score;
+            }
+        }
+        return best;
+    };
+}
+
+GameResult playGame(uint64_t seed, const Policy &policy, uint64_t max_pieces, ReplayWriter *replay, const PieceSet &pieces)
+{
+    GameResult result{seed, 0, 0, 0, {}, false};
+    PieceGenerator generator(seed, pieces);
+    TetrisBoard board;
+
+    while (result.pieces_placed < max_pieces)
+    {
+        TetrisPiece piece = generator.next();
+        std::optional<Placement> placement = policy(board, piece);
+        if (!placement)
+        {
+            result.topped_out = true;
+            break;
+        }
+        piece.setOrientation(placement->orientation);
+        if (placement->column + piece.width > TetrisBoard::width || board.landingRow(piece, placement->column) + piece.height > TetrisBoard::height)
+        {
+            result.topped_out = true;
+            break;
+        }
+
+        int cleared = board.addPiece(piece, placement->column);
+        if (replay)
+        {
+            replay->record(piece, *placement);
+        }
+        result.pieces_placed++;
+        result.lines_cleared += cleared;
+        result.score += kLineClearScores[cleared];
+        result.clears_by_size[cleared]++;
+    }
+    return result;
+}
+
+SimulationSummary simulate(uint64_t first_seed, uint64_t games, const Policy &policy, uint64_t max_pieces, const PieceSet &pieces)
+{
+    SimulationSummary summary{games, 0, 0, 0};
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t game_idx = 0; game_idx < games; game_idx++)
+    {
+        GameResult result = playGame(first_seed + game_idx, policy, max_pieces, nullptr, pieces);
+        summary.pieces_placed += result.pieces_placed;
+        summary.lines_cleared += result.lines_cleared;
+    }
+    summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return summary;
+}
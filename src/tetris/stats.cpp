@@ -0,0 +1,97 @@
+#include "tetris/stats.h"
+
+namespace
+{
+    // Head of the list of every thread's counters. Blocks are only ever pushed, never removed.
+    std::atomic<ThreadStats *> stats_head{nullptr};
+
+    constexpr std::array<const char *, kStatCounterCount> kCounterNames = {
+        "add_piece", "line_clears", "lines_cleared", "collision_checks", "rotations", "pieces_constructed"};
+    constexpr std::array<const char *, kStatTimerCount> kTimerNames = {"add_piece", "line_clear"};
+}
+
+ThreadStats &registerThreadStats()
+{
+    ThreadStats *stats = new ThreadStats;
+    stats->next = stats_head.load(std::memory_order_relaxed);
+    while (!stats_head.compare_exchange_weak(stats->next, stats, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+    thread_stats = stats;
+    return *stats;
+}
+
+StatsSnapshot collectStats()
+{
+    StatsSnapshot snapshot;
+    for (ThreadStats *stats = stats_head.load(std::memory_order_acquire); stats != nullptr; stats = stats->next)
+    {
+        for (size_t counter_idx = 0; counter_idx < kStatCounterCount; counter_idx++)
+        {
+            snapshot.counters[counter_idx] += stats->counters[counter_idx].load(std::memory_order_relaxed);
+        }
+        for (size_t timer_idx = 0; timer_idx < kStatTimerCount; timer_idx++)
+        {
+            snapshot.timer_calls[timer_idx] += stats->timer_calls[timer_idx].load(std::memory_order_relaxed);
+            snapshot.timer_nanoseconds[timer_idx] += stats->timer_nanoseconds[timer_idx].load(std::memory_order_relaxed);
+        }
+    }
+    return snapshot;
+}
+
+StatsSnapshot StatsSnapshot::operator-(const StatsSnapshot &earlier) const
+{
+    StatsSnapshot difference;
+    for (size_t counter_idx = 0; counter_idx < kStatCounterCount; counter_idx++)
+    {
+        difference.counters[counter_idx] = counters[counter_idx] - earlier.counters[counter_idx];
+    }
+    for (size_t timer_idx = 0; timer_idx < kStatTimerCount; timer_idx++)
+    {
+        difference.timer_calls[timer_idx] = timer_calls[timer_idx] - earlier.timer_calls[timer_idx];
+        difference.timer_nanoseconds[timer_idx] = timer_nanoseconds[timer_idx] - earlier.timer_nanoseconds[timer_idx];
+    }
+    return difference;
+}
+
+const char *statName(StatCounter counter_id)
+{
+    return kCounterNames[static_cast<size_t>(counter_id)];
+}
+
+const char *statName(StatTimer timer_id)
+{
+    return kTimerNames[static_cast<size_t>(timer_id)];
+}
+
+void writeStatsJson(std::ostream &out, const StatsSnapshot &snapshot)
+{
+    out << "{\"enabled\": " << (kStatsEnabled ? "true" : "false") << ", \"counters\": {";
+    for (size_t counter_idx = 0; counter_idx < kStatCounterCount; counter_idx++)
+    {
+        out << (counter_idx > 0 ? ", " : "") << '"' << kCounterNames[counter_idx] << "\": " << snapshot.counters[counter_idx];
+    }
+    out << "}, \"timers\": {";
+    for (size_t timer_idx = 0; timer_idx < kStatTimerCount; timer_idx++)
+    {
+        out << (timer_idx > 0 ? ", " : "") << '"' << kTimerNames[timer_idx] << "\": {\"calls\": " << snapshot.timer_calls[timer_idx]
+            << ", \"nanoseconds\": " << snapshot.timer_nanoseconds[timer_idx] << "}";
+    }
+    out << "}}\n";
+}
+
+void writeStatsPrometheus(std::ostream &out, const StatsSnapshot &snapshot)
+{
+    for (size_t counter_idx = 0; counter_idx < kStatCounterCount; counter_idx++)
+    {
+        out << "# TYPE tetris_" << kCounterNames[counter_idx] << "_total counter\n";
+        out << "tetris_" << kCounterNames[counter_idx] << "_total " << snapshot.counters[counter_idx] << "\n";
+    }
+    for (size_t timer_idx = 0; timer_idx < kStatTimerCount; timer_idx++)
+    {
+        out << "# TYPE tetris_" << kTimerNames[timer_idx] << "_calls_total counter\n";
+        out << "tetris_" << kTimerNames[timer_idx] << "_calls_total " << snapshot.timer_calls[timer_idx] << "\n";
+        out << "# TYPE tetris_" << kTimerNames[timer_idx] << "_seconds_total counter\n";
+        out << "tetris_" << kTimerNames[timer_idx] << "_seconds_total " << snapshot.timer_nanoseconds[timer_idx] * 1e-9 << "\n";
+    }
+}
@@ -0,0 +1,157 @@
+#include "tetris/thread_pool.h"
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+    // Pool and deque index of the current thread, if it is a worker
+    thread_local const ThreadPool *current_pool = nullptr;
+    thread_local size_t current_worker = 0;
+}
+
+ThreadPool::ThreadPool(size_t thread_count)
+{
+    if (thread_count == 0)
+    {
+        thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    for (size_t worker_idx = 0; worker_idx <= thread_count; worker_idx++)
+    {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (size_t worker_idx = 1; worker_idx <= thread_count; worker_idx++)
+    {
+        threads.emplace_back(&ThreadPool::workerLoop, this, worker_idx);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+size_t ThreadPool::ownIndex() const
+{
+    return current_pool == this ? current_worker : 0;
+}
+
+void ThreadPool::run(TaskGroup &group, std::function<void()> work)
+{
+    group.pending.fetch_add(1, std::memory_order_relaxed);
+    Worker &own = *workers[ownIndex()];
+    {
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.tasks.push_back(Task{std::move(work), &group});
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        queued.fetch_add(1, std::memory_order_relaxed);
+    }
+    wake.notify_one();
+}
+
+bool ThreadPool::takeTask(Task &task)
+{
+    size_t own_idx = ownIndex();
+
+    // Newest task from our own deque first, to keep working on the subtree that is already in cache
+    {
+        Worker &own = *workers[own_idx];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty())
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // Otherwise steal the oldest, and usually largest, task from someone else
+    for (size_t offset = 1; offset < workers.size(); offset++)
+    {
+        Worker &victim = *workers[(own_idx + offset) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::execute(Task &task)
+{
+    try
+    {
+        task.work();
+    }
+    catch (...)
+    {
+        if (!task.group->failed.exchange(true, std::memory_order_relaxed))
+        {
+            task.group->error = std::current_exception();
+        }
+    }
+    // Releases the error along with the completion, so wait sees it once pending reaches zero
+    task.group->pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void ThreadPool::workerLoop(size_t worker_idx)
+{
+    current_pool = this;
+    current_worker = worker_idx;
+
+    Task task;
+    while (true)
+    {
+        if (takeTask(task))
+        {
+            execute(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        wake.wait(lock, [this]
+                  { return stopping || queued.load(std::memory_order_relaxed) > 0; });
+        if (stopping)
+        {
+            return;
+        }
+    }
+}
+
+void ThreadPool::wait(TaskGroup &group)
+{
+    Task task;
+    while (group.pending.load(std::memory_order_acquire) > 0)
+    {
+        if (takeTask(task))
+        {
+            execute(task);
+        }
+        else
+        {
+            // The remaining tasks of the group are running on other threads
+            std::this_thread::yield();
+        }
+    }
+    if (group.failed.load(std::memory_order_relaxed))
+    {
+        std::exception_ptr error = std::exchange(group.error, nullptr);
+        group.failed.store(false, std::memory_order_relaxed);
+        std::rethrow_exception(error);
+    }
+}
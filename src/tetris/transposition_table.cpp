@@ -0,0 +1,100 @@
+#include "tetris/transposition_table.h"
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    // Data word layout, from the low bits up: depth + 1 (8), generation (8), orientation (4), column (4), row (8). The score has a word
+    // of its own. A stored depth of zero marks an empty slot.
+    uint64_t pack(const TranspositionEntry &entry, uint8_t generation)
+    {
+        uint64_t data = static_cast<uint8_t>(entry.depth + 1);
+        data |= uint64_t{generation} << 8;
+        data |= uint64_t{entry.best.orientation & 0xFu} << 16;
+        data |= uint64_t{entry.best.column & 0xFu} << 20;
+        data |= uint64_t{entry.best.row} << 24;
+        return data;
+    }
+
+    uint8_t storedDepth(uint64_t data)
+    {
+        return static_cast<uint8_t>(data);
+    }
+
+    uint8_t storedGeneration(uint64_t data)
+    {
+        return static_cast<uint8_t>(data >> 8);
+    }
+
+    TranspositionEntry unpack(uint64_t score, uint64_t data)
+    {
+        TranspositionEntry entry;
+        entry.score = std::bit_cast<double>(score);
+        entry.depth = static_cast<uint8_t>(storedDepth(data) - 1);
+        entry.best.orientation = static_cast<uint8_t>((data >> 16) & 0xF);
+        entry.best.column = static_cast<uint8_t>((data >> 20) & 0xF);
+        entry.best.row = static_cast<uint8_t>(data >> 24);
+        return entry;
+    }
+}
+
+TranspositionTable::TranspositionTable(size_t memory_bytes, ReplacementPolicy policy)
+    : policy(policy)
+{
+    if (memory_bytes < sizeof(Slot))
+    {
+        throw std::invalid_argument("Transposition table memory must hold at least one slot");
+    }
+    size_t slot_count = std::bit_floor(memory_bytes / sizeof(Slot));
+    slots = std::make_unique<Slot[]>(slot_count);
+    slot_mask = slot_count - 1;
+}
+
+bool TranspositionTable::probe(uint64_t key, TranspositionEntry &entry) const
+{
+    const Slot &slot = slots[key & slot_mask];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t score = slot.score.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if ((check ^ score ^ data) != key || storedDepth(data) == 0)
+    {
+        return false;
+    }
+    entry = unpack(score, data);
+    return true;
+}
+
+void TranspositionTable::store(uint64_t key, const TranspositionEntry &entry)
+{
+    Slot &slot = slots[key & slot_mask];
+    if (policy == ReplacementPolicy::DepthPreferred)
+    {
+        uint64_t old_data = slot.data.load(std::memory_order_relaxed);
+        bool current = storedDepth(old_data) != 0 && storedGeneration(old_data) == generation;
+        if (current && storedDepth(old_data) > entry.depth + 1)
+        {
+            return;
+        }
+    }
+    uint64_t score = std::bit_cast<uint64_t>(entry.score);
+    uint64_t data = pack(entry, generation);
+    slot.check.store(key ^ score ^ data, std::memory_order_relaxed);
+    slot.score.store(score, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::newGeneration()
+{
+    generation++;
+}
+
+void TranspositionTable::clear()
+{
+    for (size_t slot_idx = 0; slot_idx <= slot_mask; slot_idx++)
+    {
+        slots[slot_idx].check.store(0, std::memory_order_relaxed);
+        slots[slot_idx].score.store(0, std::memory_order_relaxed);
+        slots[slot_idx].data.store(0, std::memory_order_relaxed);
+    }
+}
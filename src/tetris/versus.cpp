@@ -0,0 +1,102 @@
+#include "tetris/versus.h"
+#include "tetris/zobrist.h"
+#include <algorithm>
+#include <optional>
+
+int AttackCounter::recordClear(int lines_cleared)
+{
+    if (lines_cleared == 0)
+    {
+        combo_count = -1;
+        return 0;
+    }
+
+    combo_count++;
+    longest_combo = std::max(longest_combo, combo_count);
+    int attack = kClearAttack[lines_cleared] + kComboAttack[std::min<size_t>(combo_count, kComboAttack.size() - 1)];
+    if (lines_cleared >= kDifficultClear)
+    {
+        if (back_to_back)
+        {
+            attack += kBackToBackAttack;
+            back_to_back_count++;
+        }
+        back_to_back = true;
+    }
+    else
+    {
+        back_to_back = false;
+    }
+    total_attack += attack;
+    return attack;
+}
+
+VersusResult playVersusGame(uint64_t seed, const Policy &first, const Policy &second, uint64_t max_pieces)
+{
+    struct Player
+    {
+        const Policy *policy;
+        PieceGenerator generator;
+        TetrisBoard board;
+        AttackCounter attack;
+        int pending_garbage;
+    };
+
+    VersusResult result{seed, {}, -1};
+    std::array<Player, 2> players = {Player{&first, PieceGenerator(seed), {}, {}, 0}, Player{&second, PieceGenerator(seed), {}, {}, 0}};
+    uint64_t hole_state = mixBits(seed ^ 0x5EED);
+
+    for (uint64_t piece_idx = 0; piece_idx < max_pieces; piece_idx++)
+    {
+        for (size_t player_idx = 0; player_idx < players.size(); player_idx++)
+        {
+            Player &player = players[player_idx];
+            Player &opponent = players[1 - player_idx];
+            VersusPlayerResult &stats = result.players[player_idx];
+
+            TetrisPiece piece = player.generator.next();
+            std::optional<Placement> placement = (*player.policy)(player.board, piece);
+            bool fits = false;
+            if (placement)
+            {
+                piece.setOrientation(placement->orientation);
+                fits = placement->column + piece.width <= TetrisBoard::width &&
+                       player.board.landingRow(piece, placement->column) + piece.height <= TetrisBoard::height;
+            }
+            if (!fits)
+            {
+                stats.topped_out = true;
+                result.winner = static_cast<int>(1 - player_idx);
+                return result;
+            }
+
+            int cleared = player.board.addPiece(piece, placement->column);
+            stats.pieces_placed++;
+            stats.lines_cleared += cleared;
+
+            // Attack cancels the player's own incoming garbage before anything is sent
+            int attack = player.attack.recordClear(cleared);
+            int cancelled = std::min(attack, player.pending_garbage);
+            player.pending_garbage -= cancelled;
+            opponent.pending_garbage += attack - cancelled;
+            stats.garbage_sent += attack - cancelled;
+            stats.longest_combo = player.attack.longestCombo();
+            stats.back_to_back_count = player.attack.backToBackCount();
+
+            if (cleared == 0 && player.pending_garbage > 0)
+            {
+                int hole_column = static_cast<int>(mixBits(hole_state++) % TetrisBoard::width);
+                if (player.board.maxHeight() + player.pending_garbage > TetrisBoard::height)
+                {
+                    stats.topped_out = true;
+                    result.winner = static_cast<int>(1 - player_idx);
+                    return result;
+                }
+                player.board.insertGarbage(player.pending_garbage, hole_column);
+                stats.garbage_received += player.pending_garbage;
+                player.pending_garbage = 0;
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,109 @@
+#include <cstdint>
+#include <set>
+#include <vector>
+
+#include "tetris/arena.h"
+#include "tetris/board.h"
+#include "tetris/placement.h"
+#include <gtest/gtest.h>
+
+TEST(Arena, AllocationsAreAlignedAndDisjoint)
+{
+    Arena arena(256);
+    std::vector<std::pair<uintptr_t, size_t>> ranges;
+    for (size_t size : {1, 7, 16, 3, 100, 64, 5, 300, 2})
+    {
+        for (size_t alignment : {1, 8, 32})
+        {
+            uintptr_t address = reinterpret_cast<uintptr_t>(arena.allocate(size, alignment));
+            EXPECT_EQ(address % alignment, 0u);
+            for (const auto &[start, length] : ranges)
+            {
+                EXPECT_TRUE(address + size <= start || start + length <= address);
+            }
+            ranges.emplace_back(address, size);
+        }
+    }
+    EXPECT_EQ(arena.stats().allocations, ranges.size());
+}
+
+TEST(Arena, RewindReusesMemory)
+{
+    Arena arena(1024);
+    TetrisBoard *kept = arena.create<TetrisBoard>();
+    kept->addPiece(TetrisPiece::createTPiece(), 0);
+    Arena::Marker marker = arena.mark();
+
+    std::set<TetrisBoard *> first_pass;
+    for (int idx = 0; idx < 50; idx++)
+    {
+        first_pass.insert(arena.create<TetrisBoard>());
+    }
+    uint64_t system_allocations = arena.stats().system_allocations;
+    arena.rewind(marker);
+    EXPECT_EQ(arena.stats().bytes_in_use, sizeof(TetrisBoard));
+
+    for (int idx = 0; idx < 50; idx++)
+    {
+        TetrisBoard *board = arena.create<TetrisBoard>();
+        EXPECT_TRUE(first_pass.count(board));
+        EXPECT_EQ(*board, TetrisBoard{});
+    }
+    EXPECT_EQ(arena.stats().system_allocations, system_allocations);
+    EXPECT_EQ(arena.stats().peak_bytes, 51 * sizeof(TetrisBoard));
+    EXPECT_EQ(kept->columnHeight(1), 2);
+}
+
+TEST(Arena, ScopeRewindsOnExit)
+{
+    Arena arena;
+    arena.createArray<int>(10);
+    uint64_t before = arena.stats().bytes_in_use;
+    {
+        ArenaScope scope(arena);
+        arena.createArray<Placement>(20);
+        EXPECT_GT(arena.stats().bytes_in_use, before);
+    }
+    EXPECT_EQ(arena.stats().bytes_in_use, before);
+}
+
+TEST(Arena, LargeAllocationsGetTheirOwnBlock)
+{
+    Arena arena(64);
+    ReservedMemory before = reservedMemory();
+    void *large = arena.allocate(1000, 16);
+    EXPECT_NE(large, nullptr);
+    EXPECT_EQ(arena.stats().system_allocations, 1u);
+    EXPECT_GE(arena.stats().reserved_bytes, 1000u);
+    EXPECT_GE(reservedMemory().system_allocations, before.system_allocations + 1);
+    EXPECT_THROW(Arena(0), std::invalid_argument);
+}
+
+TEST(ObjectPool, ReleasedSlotsAreReused)
+{
+    ObjectPool<TetrisBoard> pool(4);
+    std::vector<TetrisBoard *> boards;
+    for (int idx = 0; idx < 10; idx++)
+    {
+        boards.push_back(pool.acquire());
+        boards.back()->addPiece(TetrisPiece::createIPiece(), idx % 7);
+    }
+    EXPECT_EQ(pool.stats().system_allocations, 3u);
+    EXPECT_EQ(pool.stats().bytes_in_use, 10 * sizeof(TetrisBoard));
+
+    TetrisBoard *released = boards[3];
+    pool.release(released);
+    TetrisBoard *reused = pool.acquire(*boards[0]);
+    EXPECT_EQ(reused, released);
+    EXPECT_EQ(*reused, *boards[0]);
+    boards[3] = reused;
+
+    for (TetrisBoard *board : boards)
+    {
+        pool.release(board);
+    }
+    EXPECT_EQ(pool.stats().bytes_in_use, 0u);
+    EXPECT_EQ(pool.stats().peak_bytes, 10 * sizeof(TetrisBoard));
+    EXPECT_EQ(pool.stats().allocations, 11u);
+    EXPECT_EQ(pool.stats().system_allocations, 3u);
+}
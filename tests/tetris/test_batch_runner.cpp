@@ -0,0 +1,111 @@
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "tetris/batch_runner.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+    PolicyFactory greedyFactory()
+    {
+        return []
+        { return greedyPolicy(FeatureWeights{-0.51f, -0.18f, -0.36f, 0.76f, -0.05f}); };
+    }
+}
+
+TEST(BatchRunner, DeterministicAcrossThreadCounts)
+{
+    std::vector<uint64_t> seeds(12);
+    std::iota(seeds.begin(), seeds.end(), 100);
+    BatchOptions options;
+    options.max_pieces = 300;
+    options.score_bucket_width = 1000;
+    options.bucket_count = 20;
+
+    options.thread_count = 1;
+    BatchResult single = runBatch(seeds, greedyFactory(), options);
+    options.thread_count = 5;
+    BatchResult many = runBatch(seeds, greedyFactory(), options);
+
+    EXPECT_EQ(single.statistics, many.statistics);
+    ASSERT_EQ(many.games.size(), seeds.size());
+    for (size_t idx = 0; idx < seeds.size(); idx++)
+    {
+        EXPECT_EQ(many.games[idx].seed, seeds[idx]);
+        EXPECT_EQ(many.games[idx].score, single.games[idx].score);
+    }
+}
+
+TEST(BatchRunner, StatisticsMatchGames)
+{
+    std::vector<uint64_t> seeds = {1, 2, 3, 4};
+    BatchOptions options;
+    options.thread_count = 2;
+    options.max_pieces = 200;
+    options.score_bucket_width = 500;
+    options.bucket_count = 4;
+    BatchResult result = runBatch(seeds, greedyFactory(), options);
+
+    uint64_t pieces = 0;
+    uint64_t histogram_total = 0;
+    for (const GameResult &game : result.games)
+    {
+        pieces += game.pieces_placed;
+    }
+    for (uint64_t count : result.statistics.score_histogram)
+    {
+        histogram_total += count;
+    }
+    EXPECT_EQ(result.statistics.games, seeds.size());
+    EXPECT_EQ(result.statistics.pieces_placed, pieces);
+    EXPECT_EQ(histogram_total, seeds.size());
+}
+
+TEST(BatchRunner, RethrowsWorkerExceptions)
+{
+    std::vector<uint64_t> seeds(20);
+    std::iota(seeds.begin(), seeds.end(), 0);
+    BatchOptions options;
+    options.max_pieces = 50;
+    options.thread_count = 4;
+
+    // A policy which fails on its thirtieth call, counted across the games of its worker
+    PolicyFactory failing = []
+    {
+        return [calls = 0](const TetrisBoard &, const TetrisPiece &) mutable -> std::optional<Placement>
+        {
+            if (++calls == 30)
+            {
+                throw std::runtime_error("policy failed");
+            }
+            return Placement{0, 0, 0};
+        };
+    };
+    EXPECT_THROW(runBatch(seeds, failing, options), std::runtime_error);
+
+    PolicyFactory failing_factory = []() -> Policy
+    { throw std::logic_error("no policy"); };
+    EXPECT_THROW(runBatch(seeds, failing_factory, options), std::logic_error);
+}
+
+TEST(BatchStatistics, HistogramOverflowBucket)
+{
+    BatchStatistics statistics(100, 3);
+    GameResult game{};
+    game.score = 250;
+    statistics.add(game);
+    game.score = 5000;
+    statistics.add(game);
+
+    EXPECT_EQ(statistics.score_histogram, (std::vector<uint64_t>{0, 0, 2}));
+}
+
+TEST(BatchStatistics, InvalidLayouts)
+{
+    EXPECT_THROW(BatchStatistics(0, 3), std::invalid_argument);
+    EXPECT_THROW(BatchStatistics(10, 0), std::invalid_argument);
+    BatchStatistics statistics(10, 3);
+    EXPECT_THROW(statistics.merge(BatchStatistics(10, 4)), std::invalid_argument);
+}
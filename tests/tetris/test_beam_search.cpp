@@ -0,0 +1,151 @@
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "tetris/beam_search.h"
+#include "tetris/simulator.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+    double flatBoard(const TetrisBoard &board, int lines_cleared)
+    {
+        return lines_cleared * 10.0 - board.maxHeight() - 4.0 * board.holes();
+    }
+
+    std::vector<TetrisPiece> dealPieces(uint64_t seed, size_t count)
+    {
+        PieceGenerator generator(seed);
+        std::vector<TetrisPiece> pieces;
+        for (size_t idx = 0; idx < count; idx++)
+        {
+            pieces.push_back(generator.next());
+        }
+        return pieces;
+    }
+}
+
+TEST(BeamSearch, WideBeamMatchesExhaustiveSearch)
+{
+    ThreadPool pool(4);
+    GameTreeSearch exhaustive(flatBoard, pool);
+    TetrisBoard board;
+    board.addPiece(TetrisPiece::createLPiece(), 0);
+    board.addPiece(TetrisPiece::createZPiece(), 4);
+    std::vector<TetrisPiece> pieces = {TetrisPiece::createTPiece(), TetrisPiece::createIPiece()};
+    SearchResult expected = exhaustive.search(board, pieces);
+
+    // Wide enough to keep every node, so nothing is pruned
+    for (bool deduplicate : {false, true})
+    {
+        BeamOptions options;
+        options.width = kMaxPlacements * kMaxPlacements;
+        options.deduplicate = deduplicate;
+        BeamSearch beam(flatBoard, pool, options);
+        SearchResult result = beam.search(board, pieces);
+        ASSERT_TRUE(result.found);
+        EXPECT_DOUBLE_EQ(result.score, expected.score);
+        EXPECT_EQ(beam.counters().pruned, 0u);
+        if (!deduplicate)
+        {
+            EXPECT_EQ(result.placement, expected.placement);
+            EXPECT_EQ(beam.counters().duplicates, 0u);
+        }
+    }
+}
+
+TEST(BeamSearch, MergesTranspositions)
+{
+    ThreadPool pool(2);
+    BeamOptions options;
+    options.width = 256;
+    BeamSearch beam(flatBoard, pool, options);
+    // Two squares side by side give the same board whichever is placed first
+    std::vector<TetrisPiece> pieces = {TetrisPiece::createQPiece(), TetrisPiece::createQPiece()};
+    SearchResult result = beam.search(TetrisBoard{}, pieces);
+    ASSERT_TRUE(result.found);
+
+    // A square has nine columns on an empty board. Squares two or more columns apart commute, giving 28 unordered pairs.
+    const BeamCounters &counters = beam.counters();
+    EXPECT_EQ(counters.expanded, 1u + 9u);
+    EXPECT_EQ(counters.candidates, 9u + 9u * 9u);
+    EXPECT_EQ(counters.duplicates, 28u);
+    EXPECT_EQ(counters.pruned, 0u);
+
+    beam.resetCounters();
+    EXPECT_EQ(beam.counters().candidates, 0u);
+}
+
+TEST(BeamSearch, ThreadedExpansionMatchesSerial)
+{
+    ThreadPool pool(4);
+    BeamOptions serial_options;
+    serial_options.width = 48;
+    serial_options.nodes_per_task = 0;
+    BeamOptions parallel_options = serial_options;
+    parallel_options.nodes_per_task = 3;
+    BeamSearch serial(flatBoard, pool, serial_options);
+    BeamSearch parallel(flatBoard, pool, parallel_options);
+
+    for (uint64_t seed = 0; seed < 4; seed++)
+    {
+        std::vector<TetrisPiece> pieces = dealPieces(seed, 12);
+        SearchResult expected = serial.search(TetrisBoard{}, pieces);
+        SearchResult result = parallel.search(TetrisBoard{}, pieces);
+        ASSERT_TRUE(expected.found);
+        EXPECT_TRUE(std::isfinite(expected.score));
+        EXPECT_EQ(result.placement, expected.placement);
+        EXPECT_DOUBLE_EQ(result.score, expected.score);
+    }
+    EXPECT_LE(serial.counters().expanded, 4u * (1 + 11 * serial_options.width));
+}
+
+TEST(BeamSearch, PlaysLongGames)
+{
+    ThreadPool pool(2);
+    BeamOptions options;
+    options.width = 16;
+    BeamSearch beam(flatBoard, pool, options);
+    std::vector<TetrisPiece> preview;
+    Policy policy = [&](const TetrisBoard &board, const TetrisPiece &piece) -> std::optional<Placement>
+    {
+        // No real preview is dealt, so plan the current piece twice and then an I piece
+        preview.assign({piece, piece, TetrisPiece::createIPiece()});
+        SearchResult result = beam.search(board, preview);
+        if (!result.found)
+        {
+            return std::nullopt;
+        }
+        return result.placement;
+    };
+    GameResult game = playGame(3, policy, 200);
+    EXPECT_EQ(game.pieces_placed, 200u);
+    EXPECT_GT(game.lines_cleared, 0u);
+}
+
+TEST(BeamSearch, RejectsBadArguments)
+{
+    ThreadPool pool(1);
+    BeamOptions options;
+    options.width = 0;
+    EXPECT_THROW(BeamSearch(flatBoard, pool, options), std::invalid_argument);
+
+    BeamSearch beam(flatBoard, pool);
+    EXPECT_THROW(beam.search(TetrisBoard{}, std::span<const TetrisPiece>{}), std::invalid_argument);
+
+    // A board too full for the piece to be placed at all
+    TetrisBoard full;
+    for (int col_idx = 0; col_idx + 1 < TetrisBoard::width; col_idx++)
+    {
+        for (int row_idx = 0; row_idx < TetrisBoard::height; row_idx++)
+        {
+            full.addPiece(TetrisPiece{{{true}}}, col_idx);
+        }
+    }
+    std::vector<TetrisPiece> pieces = {TetrisPiece::createQPiece()};
+    SearchResult result = beam.search(full, pieces);
+    EXPECT_FALSE(result.found);
+    EXPECT_EQ(result.score, -std::numeric_limits<double>::infinity());
+}
@@ -0,0 +1,578 @@
+#include <algorithm>
+#include <bit>
+#include <span>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "tetris/board.h"
+#include <gtest/gtest.h>
+
+TEST(BasicBoard, EmptyBoard)
+{
+    TetrisBoard board;
+
+    EXPECT_EQ(board.maxHeight(), 0);
+    for (int col_idx = 0; col_idx < TetrisBoard::width; col_idx++)
+    {
+        EXPECT_EQ(board.highestBlockInColumn(col_idx), -1);
+    }
+}
+
+TEST(BasicBoard, AddPieceLandsOnFloor)
+{
+    TetrisBoard board;
+    EXPECT_EQ(board.addPiece(TetrisPiece::createIPiece(), 0), 0);
+
+    EXPECT_EQ(board.maxHeight(), 1);
+    EXPECT_EQ(board.row(0), 0b1111);
+    EXPECT_EQ(board.highestBlockInColumn(3), 0);
+    EXPECT_EQ(board.highestBlockInColumn(4), -1);
+}
+
+TEST(BasicBoard, AddPieceStacks)
+{
+    TetrisBoard board;
+    board.addPiece(TetrisPiece::createQPiece(), 0);
+    board.addPiece(TetrisPiece::createQPiece(), 1);
+
+    EXPECT_EQ(board.maxHeight(), 4);
+    EXPECT_EQ(board.highestBlockInColumn(0), 1);
+    EXPECT_EQ(board.highestBlockInColumn(1), 3);
+    EXPECT_EQ(board.highestBlockInColumn(2), 3);
+}
+
+TEST(BasicBoard, AddPieceRestsOnSkirt)
+{
+    // T piece pointing down, dropped over a single block, rests on its stem and leaves holes under its arms
+    TetrisBoard board;
+    board.addPiece(TetrisPiece{{{true}}}, 1);
+    TetrisPiece t_piece = TetrisPiece::createTPiece();
+    EXPECT_EQ(board.landingRow(t_piece, 0), 1);
+    board.addPiece(t_piece, 0);
+
+    EXPECT_TRUE(board.at(0, 2));
+    EXPECT_TRUE(board.at(1, 1));
+    EXPECT_FALSE(board.at(0, 1));
+    EXPECT_FALSE(board.at(2, 0));
+    EXPECT_EQ(board.maxHeight(), 3);
+}
+
+TEST(BasicBoard, LineClear)
+{
+    TetrisBoard board;
+    board.addPiece(TetrisPiece::createIPiece(), 0);
+    board.addPiece(TetrisPiece::createIPiece(), 4);
+    board.addPiece(TetrisPiece{{{true}}}, 8);
+    board.addPiece(TetrisPiece{{{true, true}}}, 8);
+    EXPECT_EQ(board.maxHeight(), 3);
+
+    // The final cell completes the bottom row, and the column above it falls
+    EXPECT_EQ(board.addPiece(TetrisPiece{{{true}}}, 9), 1);
+    EXPECT_EQ(board.maxHeight(), 2);
+    EXPECT_EQ(board.row(0), 0b0100000000);
+    EXPECT_EQ(board.row(1), 0b0100000000);
+    EXPECT_EQ(board.row(2), 0);
+}
+
+TEST(BasicBoard, MultipleLineClear)
+{
+    TetrisBoard board;
+    TetrisPiece q_piece = TetrisPiece::createQPiece();
+    for (int col_idx = 0; col_idx < 8; col_idx += 2)
+    {
+        board.addPiece(q_piece, col_idx);
+    }
+    board.addPiece(TetrisPiece{{{true, true, true}}}, 9);
+
+    EXPECT_EQ(board.addPiece(TetrisPiece{{{true, true}}}, 8), 2);
+    EXPECT_EQ(board.maxHeight(), 1);
+    EXPECT_EQ(board.row(0), 0b1000000000);
+}
+
+TEST(BasicBoard, Collides)
+{
+    TetrisBoard board;
+    board.addPiece(TetrisPiece::createQPiece(), 0);
+    TetrisPiece i_piece = TetrisPiece::createIPiece();
+
+    EXPECT_TRUE(board.collides(i_piece, 0, 0));
+    EXPECT_FALSE(board.collides(i_piece, 2, 0));
+    EXPECT_FALSE(board.collides(i_piece, 0, 2));
+    EXPECT_TRUE(board.collides(i_piece, -1, 5));
+    EXPECT_TRUE(board.collides(i_piece, 7, 5));
+    EXPECT_TRUE(board.collides(i_piece, 0, -1));
+    EXPECT_TRUE(board.collides(i_piece, 0, TetrisBoard::height));
+}
+
+TEST(BasicBoard, InvalidColumn)
+{
+    TetrisBoard board;
+
+    EXPECT_THROW(board.addPiece(TetrisPiece::createIPiece(), -1), std::out_of_range);
+    EXPECT_THROW(board.addPiece(TetrisPiece::createIPiece(), 7), std::out_of_range);
+    EXPECT_THROW(board.highestBlockInColumn(TetrisBoard::width), std::out_of_range);
+}
+
+TEST(BasicBoard, TopOut)
+{
+    TetrisBoard board;
+    TetrisPiece i_piece = TetrisPiece::createIPiece();
+    i_piece.rotateClockwise();
+    for (int drop = 0; drop < TetrisBoard::height / 4; drop++)
+    {
+        board.addPiece(i_piece, 0);
+    }
+
+    EXPECT_THROW(board.addPiece(i_piece, 0), std::overflow_error);
+}
+
+TEST(BoardMetrics, HolesUnderOverhang)
+{
+    TetrisBoard board;
+    board.addPiece(TetrisPiece{{{true}}}, 1);
+    board.addPiece(TetrisPiece::createTPiece(), 0);
+
+    EXPECT_EQ(board.holesInColumn(0), 2);
+    EXPECT_EQ(board.holesInColumn(1), 0);
+    EXPECT_EQ(board.holesInColumn(2), 2);
+    EXPECT_EQ(board.holes(), 4);
+    EXPECT_EQ(board.columnHeight(1), 3);
+}
+
+TEST(BoardMetrics, MatchFullRescan)
+{
+    // Drop a long reproducible sequence of pieces and compare the incremental metrics against a full rescan after every drop
+    std::mt19937 rng(1234);
+    std::vector<TetrisPiece> pieces;
+    for (const auto &[name, factory] : TetrisPiece::pieceFactories)
+    {
+        pieces.push_back(factory());
+    }
+
+    TetrisBoard board;
+    for (int drop = 0; drop < 2000; drop++)
+    {
+        TetrisPiece piece = pieces[rng() % pieces.size()];
+        for (int turn = rng() % 8; turn > 0; turn--)
+        {
+            turn >= 4 ? piece.flipHorizontal() : piece.rotateClockwise();
+        }
+        int col_offset = rng() % (TetrisBoard::width - piece.width + 1);
+        if (board.landingRow(piece, col_offset) + piece.height > TetrisBoard::height)
+        {
+            board = TetrisBoard{};
+            continue;
+        }
+        board.addPiece(piece, col_offset);
+
+        int expected_max = 0;
+        int expected_holes = 0;
+        for (int col_idx = 0; col_idx < TetrisBoard::width; col_idx++)
+        {
+            int col_height = 0;
+            int col_holes = 0;
+            for (int row_idx = 0; row_idx < TetrisBoard::height; row_idx++)
+            {
+                if (board.at(col_idx, row_idx))
+                {
+                    col_holes += row_idx - col_height;
+                    col_height = row_idx + 1;
+                }
+            }
+            ASSERT_EQ(board.columnHeight(col_idx), col_height) << "drop " << drop << "\n"
+                                                               << board;
+            ASSERT_EQ(board.holesInColumn(col_idx), col_holes) << "drop " << drop << "\n"
+                                                               << board;
+            expected_max = std::max(expected_max, col_height);
+            expected_holes += col_holes;
+        }
+        ASSERT_EQ(board.maxHeight(), expected_max);
+        ASSERT_EQ(board.holes(), expected_holes);
+
+        uint64_t expected_hash = 0;
+        for (int row_idx = 0; row_idx < TetrisBoard::height; row_idx++)
+        {
+            expected_hash ^= zobristRow(row_idx, board.row(row_idx));
+        }
+        ASSERT_EQ(board.hash(), expected_hash);
+    }
+}
+
+// Cell by cell overlap test which treats everything above the board as empty
+bool overlapsBoard(const TetrisBoard &board, const TetrisPiece &piece, int col_offset, int row_offset)
+{
+    for (int col_idx = 0; col_idx < piece.width; col_idx++)
+    {
+        for (int row_idx = 0; row_idx < piece.height; row_idx++)
+        {
+            int board_row = row_offset + row_idx;
+            if (piece.at(col_idx, row_idx) && board_row < TetrisBoard::height && board.at(col_offset + col_idx, board_row))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+TEST(BoardLanding, MatchesStepwiseDrop)
+{
+    // Compare the skirt based landing row against stepping each piece down one row at a time
+    std::mt19937 rng(99);
+    std::vector<TetrisPiece> pieces;
+    for (const auto &[name, factory] : TetrisPiece::pieceFactories)
+    {
+        pieces.push_back(factory());
+    }
+
+    TetrisBoard board;
+    for (int drop = 0; drop < 2000; drop++)
+    {
+        TetrisPiece piece = pieces[rng() % pieces.size()];
+        for (int turn = rng() % 4; turn > 0; turn--)
+        {
+            piece.rotateClockwise();
+        }
+        for (int col_offset = 0; col_offset + piece.width <= TetrisBoard::width; col_offset++)
+        {
+            // Start entirely above the board, where every row is empty
+            int expected = TetrisBoard::height;
+            while (expected > 0 && !overlapsBoard(board, piece, col_offset, expected - 1))
+            {
+                expected--;
+            }
+            ASSERT_EQ(board.landingRow(piece, col_offset), expected) << "col " << col_offset << "\n" << board << piece;
+        }
+
+        int col_offset = rng() % (TetrisBoard::width - piece.width + 1);
+        if (board.landingRow(piece, col_offset) + piece.height > TetrisBoard::height)
+        {
+            board = TetrisBoard{};
+            continue;
+        }
+        board.addPiece(piece, col_offset);
+    }
+}
+
+TEST(BasicBoard, StreamOperator)
+{
+    TetrisBoard board;
+    board.addPiece(TetrisPiece{{{true}}}, 0);
+    std::stringstream ss;
+    ss << board;
+
+    std::string output = ss.str();
+    std::string bottom = "|X         |\n------------\n";
+    EXPECT_EQ(output.substr(output.size() - bottom.size()), bottom);
+}
+
+TEST(BasicBoard, ConstructFromRows)
+{
+    TetrisBoard played;
+    played.addPiece(TetrisPiece{{{true}}}, 1);
+    played.addPiece(TetrisPiece::createTPiece(), 0);
+    played.addPiece(TetrisPiece::createLPiece(), 6);
+
+    std::vector<TetrisBoard::Row> rows;
+    for (int row_idx = 0; row_idx < TetrisBoard::height; row_idx++)
+    {
+        rows.push_back(played.row(row_idx));
+    }
+    TetrisBoard restored(rows);
+
+    EXPECT_EQ(restored, played);
+    EXPECT_EQ(restored.hash(), played.hash());
+    EXPECT_EQ(restored.holes(), played.holes());
+    EXPECT_EQ(restored.maxHeight(), played.maxHeight());
+    for (int col_idx = 0; col_idx < TetrisBoard::width; col_idx++)
+    {
+        EXPECT_EQ(restored.columnHeight(col_idx), played.columnHeight(col_idx));
+    }
+
+    rows.pop_back();
+    EXPECT_THROW(TetrisBoard{rows}, std::invalid_argument);
+    rows.push_back(TetrisBoard::kFullRow + 1);
+    EXPECT_THROW(TetrisBoard{rows}, std::invalid_argument);
+}
+
+static_assert(std::is_same_v<TetrisBoard::Row, uint16_t>);
+static_assert(std::is_same_v<BasicTetrisBoard<16, 20>::Row, uint16_t>);
+static_assert(std::is_same_v<BasicTetrisBoard<17, 20>::Row, uint32_t>);
+static_assert(std::is_same_v<BasicTetrisBoard<32, 20>::Row, uint32_t>);
+static_assert(std::is_same_v<BasicTetrisBoard<33, 20>::Row, uint64_t>);
+static_assert(BasicTetrisBoard<64, 64>::kFullRow == ~uint64_t{0});
+static_assert(BasicTetrisBoard<16, 8>::kFullRow == 0xFFFF);
+
+template <typename Board>
+class BoardSizes : public testing::Test
+{
+};
+
+using BoardSizeTypes = testing::Types<BasicTetrisBoard<4, 8>, TetrisBoard, BasicTetrisBoard<16, 32>, BasicTetrisBoard<24, 40>,
+                                      BasicTetrisBoard<32, 33>, BasicTetrisBoard<48, 64>, BasicTetrisBoard<64, 64>>;
+TYPED_TEST_SUITE(BoardSizes, BoardSizeTypes);
+
+TYPED_TEST(BoardSizes, MatchesDynamicBoard)
+{
+    // Play the same drops on the fixed size board and the run time sized fallback, and check both against a full rescan
+    using Board = TypeParam;
+    std::mt19937 rng(Board::width * 100 + Board::height);
+    std::vector<TetrisPiece> pieces;
+    for (const auto &[name, factory] : TetrisPiece::pieceFactories)
+    {
+        pieces.push_back(factory());
+    }
+
+    Board board;
+    DynamicTetrisBoard dynamic(Board::width, Board::height);
+    int total_cleared = 0;
+    for (int drop = 0; drop < 3000; drop++)
+    {
+        TetrisPiece piece = pieces[rng() % pieces.size()];
+        piece.setOrientation(rng() % kOrientationCount);
+        if (piece.width > Board::width)
+        {
+            continue;
+        }
+        int col_offset = rng() % (Board::width - piece.width + 1);
+        ASSERT_EQ(board.landingRow(piece, col_offset), dynamic.landingRow(piece, col_offset));
+        if (board.landingRow(piece, col_offset) + piece.height > Board::height)
+        {
+            EXPECT_THROW(board.addPiece(piece, col_offset), std::overflow_error);
+            EXPECT_THROW(dynamic.addPiece(piece, col_offset), std::overflow_error);
+            board = Board{};
+            dynamic = DynamicTetrisBoard(Board::width, Board::height);
+            continue;
+        }
+        int cleared = board.addPiece(piece, col_offset);
+        ASSERT_EQ(dynamic.addPiece(piece, col_offset), cleared);
+        total_cleared += cleared;
+
+        uint64_t expected_hash = 0;
+        for (int row_idx = 0; row_idx < Board::height; row_idx++)
+        {
+            ASSERT_EQ(board.row(row_idx), dynamic.row(row_idx)) << "drop " << drop << "\n" << board;
+            expected_hash ^= zobristRow(row_idx, board.row(row_idx));
+        }
+        int expected_holes = 0;
+        for (int col_idx = 0; col_idx < Board::width; col_idx++)
+        {
+            int col_height = 0;
+            int col_holes = 0;
+            for (int row_idx = 0; row_idx < Board::height; row_idx++)
+            {
+                if (board.at(col_idx, row_idx))
+                {
+                    col_holes += row_idx - col_height;
+                    col_height = row_idx + 1;
+                }
+            }
+            ASSERT_EQ(board.columnHeight(col_idx), col_height) << "drop " << drop << "\n" << board;
+            ASSERT_EQ(dynamic.columnHeight(col_idx), col_height) << "drop " << drop << "\n" << dynamic;
+            expected_holes += col_holes;
+        }
+        ASSERT_EQ(board.holes(), expected_holes);
+        ASSERT_EQ(dynamic.holes(), expected_holes);
+        ASSERT_EQ(board.maxHeight(), dynamic.maxHeight());
+        ASSERT_EQ(board.hash(), expected_hash);
+        ASSERT_EQ(dynamic.hash(), expected_hash);
+    }
+    if (Board::width <= 10)
+    {
+        EXPECT_GT(total_cleared, 0);
+    }
+
+    // Fill the bottom row one cell at a time, then finish it with a domino which leaves its top cell behind
+    board = Board{};
+    dynamic = DynamicTetrisBoard(Board::width, Board::height);
+    TetrisPiece cell(0x1, 1, 1);
+    TetrisPiece domino(0x0101, 1, 2);
+    for (int col_idx = 1; col_idx < Board::width; col_idx++)
+    {
+        EXPECT_EQ(board.addPiece(cell, col_idx), 0);
+        EXPECT_EQ(dynamic.addPiece(cell, col_idx), 0);
+    }
+    EXPECT_EQ(board.addPiece(domino, 0), 1);
+    EXPECT_EQ(dynamic.addPiece(domino, 0), 1);
+    EXPECT_EQ(board.row(0), 1u);
+    EXPECT_EQ(dynamic.row(0), 1u);
+    EXPECT_EQ(board.maxHeight(), 1);
+    EXPECT_EQ(dynamic.maxHeight(), 1);
+    EXPECT_EQ(board.hash(), dynamic.hash());
+}
+
+// Check that every cell, metric and the hash of two boards match
+template <typename Board>
+void expectSameBoard(const Board &board, const Board &expected, int width)
+{
+    ASSERT_TRUE(board == expected) << board << expected;
+    for (int col_idx = 0; col_idx < width; col_idx++)
+    {
+        ASSERT_EQ(board.columnHeight(col_idx), expected.columnHeight(col_idx));
+        ASSERT_EQ(board.holesInColumn(col_idx), expected.holesInColumn(col_idx));
+    }
+    ASSERT_EQ(board.maxHeight(), expected.maxHeight());
+    ASSERT_EQ(board.holes(), expected.holes());
+    ASSERT_EQ(board.hash(), expected.hash());
+}
+
+TYPED_TEST(BoardSizes, MakeUnmakeRestoresBoard)
+{
+    // Make stacks of moves on one board, then unmake them all, checking against copies taken before each move
+    using Board = TypeParam;
+    std::mt19937 rng(Board::width * 7 + Board::height);
+    std::vector<TetrisPiece> pieces;
+    for (const auto &[name, factory] : TetrisPiece::pieceFactories)
+    {
+        pieces.push_back(factory());
+    }
+
+    Board board;
+    DynamicTetrisBoard dynamic(Board::width, Board::height);
+    int total_cleared = 0;
+    for (int round = 0; round < 300; round++)
+    {
+        std::vector<Board> saved;
+        std::vector<DynamicTetrisBoard> saved_dynamic;
+        std::vector<typename Board::UndoRecord> undos;
+        std::vector<DynamicTetrisBoard::UndoRecord> dynamic_undos;
+        for (int ply = 0; ply < 6; ply++)
+        {
+            TetrisPiece piece = pieces[rng() % pieces.size()];
+            piece.setOrientation(rng() % kOrientationCount);
+            if (piece.width > Board::width)
+            {
+                continue;
+            }
+            int col_offset = rng() % (Board::width - piece.width + 1);
+            if (board.landingRow(piece, col_offset) + piece.height > Board::height)
+            {
+                break;
+            }
+            saved.push_back(board);
+            saved_dynamic.push_back(dynamic);
+            undos.emplace_back();
+            dynamic_undos.emplace_back();
+            int cleared = board.makeMove(piece, col_offset, undos.back());
+            ASSERT_EQ(dynamic.makeMove(piece, col_offset, dynamic_undos.back()), cleared);
+            total_cleared += cleared;
+        }
+        while (!undos.empty())
+        {
+            board.unmakeMove(undos.back());
+            dynamic.unmakeMove(dynamic_undos.back());
+            expectSameBoard(board, saved.back(), Board::width);
+            expectSameBoard(dynamic, saved_dynamic.back(), Board::width);
+            undos.pop_back();
+            dynamic_undos.pop_back();
+            saved.pop_back();
+            saved_dynamic.pop_back();
+        }
+
+        // Keep one move so the stack grows between rounds, starting over once it reaches the top
+        TetrisPiece piece = pieces[rng() % pieces.size()];
+        int col_offset = static_cast<int>(rng() % (Board::width - piece.width + 1));
+        if (board.landingRow(piece, col_offset) + piece.height > Board::height)
+        {
+            board = Board{};
+            dynamic = DynamicTetrisBoard(Board::width, Board::height);
+            continue;
+        }
+        board.addPiece(piece, col_offset);
+        dynamic.addPiece(piece, col_offset);
+    }
+    if (Board::width <= 10)
+    {
+        EXPECT_GT(total_cleared, 0);
+    }
+
+    // A failed move leaves the board and the record alone
+    typename Board::UndoRecord undo{};
+    EXPECT_THROW(board.makeMove(TetrisPiece::createQPiece(), Board::width, undo), std::out_of_range);
+    EXPECT_EQ(undo.piece_cells, 0u);
+}
+
+TYPED_TEST(BoardSizes, ClearRowsAndInsertGarbage)
+{
+    using Board = TypeParam;
+    using Row = typename Board::Row;
+
+    // Alternate full rows with rows missing one cell, so the clear removes every other row
+    std::vector<Row> board_rows(Board::height, 0);
+    std::vector<Row> expected_rows(Board::height, 0);
+    int stack = std::min(Board::height, 8);
+    for (int row_idx = 0; row_idx < stack; row_idx++)
+    {
+        board_rows[row_idx] = row_idx % 2 == 0 ? Board::kFullRow : static_cast<Row>(Board::kFullRow >> 1);
+        if (row_idx % 2 == 1)
+        {
+            expected_rows[row_idx / 2] = board_rows[row_idx];
+        }
+    }
+    Board board{std::span<const Row>(board_rows)};
+    typename Board::RowMask full = board.fullRows();
+    EXPECT_EQ(std::popcount(full), stack / 2);
+    EXPECT_THROW(board.clearRows(full | 2), std::invalid_argument);
+    EXPECT_EQ(board.clearRows(full), stack / 2);
+    expectSameBoard(board, Board{std::span<const Row>(expected_rows)}, Board::width);
+    EXPECT_EQ(board.fullRows(), 0u);
+
+    // Garbage goes underneath the stack, and the hole column only rises if it already had cells
+    int garbage = 3;
+    int hole_column = Board::width - 1;
+    std::vector<Row> garbage_rows(Board::height, 0);
+    for (int row_idx = 0; row_idx < garbage; row_idx++)
+    {
+        garbage_rows[row_idx] = Board::kFullRow & ~(Row{1} << hole_column);
+    }
+    std::copy(expected_rows.begin(), expected_rows.end() - garbage, garbage_rows.begin() + garbage);
+    board.insertGarbage(garbage, hole_column);
+    expectSameBoard(board, Board{std::span<const Row>(garbage_rows)}, Board::width);
+    Board empty;
+    empty.insertGarbage(garbage, 0);
+    EXPECT_EQ(empty.columnHeight(0), 0);
+    EXPECT_EQ(empty.maxHeight(), garbage);
+
+    // The run time sized board agrees, and filling the hole of the bottom garbage row clears it
+    Board fixed;
+    DynamicTetrisBoard dynamic(Board::width, Board::height);
+    fixed.insertGarbage(garbage, hole_column);
+    dynamic.insertGarbage(garbage, hole_column);
+    EXPECT_EQ(dynamic.fullRows(), 0u);
+    EXPECT_THROW(dynamic.clearRows(1), std::invalid_argument);
+    TetrisPiece cell(0x1, 1, 1);
+    EXPECT_EQ(fixed.addPiece(cell, hole_column), 1);
+    EXPECT_EQ(dynamic.addPiece(cell, hole_column), 1);
+    for (int row_idx = 0; row_idx < Board::height; row_idx++)
+    {
+        ASSERT_EQ(fixed.row(row_idx), dynamic.row(row_idx));
+    }
+    EXPECT_EQ(fixed.hash(), dynamic.hash());
+    EXPECT_EQ(fixed.holes(), dynamic.holes());
+    EXPECT_EQ(fixed.maxHeight(), dynamic.maxHeight());
+
+    EXPECT_THROW(board.insertGarbage(-1, 0), std::invalid_argument);
+    EXPECT_THROW(board.insertGarbage(1, Board::width), std::out_of_range);
+    Board before = board;
+    EXPECT_THROW(board.insertGarbage(Board::height, 0), std::overflow_error);
+    expectSameBoard(board, before, Board::width);
+}
+
+TEST(DynamicBoard, InvalidDimensions)
+{
+    EXPECT_THROW(DynamicTetrisBoard(0, 10), std::invalid_argument);
+    EXPECT_THROW(DynamicTetrisBoard(10, 65), std::invalid_argument);
+    EXPECT_THROW(DynamicTetrisBoard(65, 10), std::invalid_argument);
+
+    DynamicTetrisBoard board(5, 4);
+    EXPECT_THROW(board.addPiece(TetrisPiece::createIPiece(), 2), std::out_of_range);
+    EXPECT_THROW(board.highestBlockInColumn(5), std::out_of_range);
+    board.addPiece(TetrisPiece::createIPiece(), 1);
+    std::stringstream stream;
+    stream << board;
+    EXPECT_EQ(stream.str(), "-------\n|     |\n|     |\n|     |\n| XXXX|\n-------\n");
+}
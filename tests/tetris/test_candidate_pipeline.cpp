@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <array>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "tetris/candidate_pipeline.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+    const FeatureWeights kWeights{-0.51f, -0.18f, -0.36f, 0.76f, -0.05f};
+
+    double featureScore(const TetrisBoard &board, int lines_cleared)
+    {
+        return scoreFeatures(computeFeatures(board, lines_cleared), kWeights);
+    }
+
+    // Boards from a reproducible random game, restarted whenever it tops out
+    std::vector<TetrisBoard> randomBoards(size_t count, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::vector<TetrisBoard> boards;
+        TetrisBoard board;
+        while (boards.size() < count)
+        {
+            TetrisPiece piece = standardPiece(static_cast<PieceId>(rng() % kStandardPieces.size()));
+            piece.setOrientation(rng() % kOrientationCount);
+            int col_offset = rng() % (TetrisBoard::width - piece.width + 1);
+            if (board.landingRow(piece, col_offset) + piece.height > TetrisBoard::height)
+            {
+                board = TetrisBoard{};
+            }
+            board.addPiece(piece, col_offset);
+            boards.push_back(board);
+        }
+        return boards;
+    }
+}
+
+TEST(CandidatePipeline, EstimateMatchesPlacedBoard)
+{
+    size_t clearing = 0;
+    for (const TetrisBoard &board : randomBoards(200, 3))
+    {
+        for (const PieceOrientationTable &table : kStandardPieces)
+        {
+            std::array<Placement, kMaxPlacements> placements;
+            size_t count = enumeratePlacements(board, table.pieces[0], placements);
+            for (size_t placement_idx = 0; placement_idx < count; placement_idx++)
+            {
+                const TetrisPiece &piece = table.pieces[placements[placement_idx].orientation];
+                BoardFeatures estimate = estimateFeatures(board, piece, placements[placement_idx]);
+                TetrisBoard child = board;
+                int cleared = child.addPiece(piece, placements[placement_idx].column);
+                BoardFeatures actual = computeFeatures(child, cleared);
+
+                EXPECT_EQ(estimate.completed_lines, cleared);
+                EXPECT_EQ(estimate.bumpiness, 0);
+                if (cleared == 0)
+                {
+                    EXPECT_EQ(estimate.aggregate_height, actual.aggregate_height);
+                    EXPECT_EQ(estimate.holes, actual.holes);
+                    EXPECT_EQ(estimate.max_height, actual.max_height);
+                }
+                clearing += cleared > 0;
+            }
+        }
+    }
+    EXPECT_GT(clearing, 0u);
+}
+
+TEST(CandidatePipeline, WithoutPruningMatchesGreedy)
+{
+    PipelineOptions options;
+    options.prune = false;
+    for (uint64_t seed = 0; seed < 5; seed++)
+    {
+        GameResult greedy = playGame(seed, greedyPolicy(kWeights), 300);
+        GameResult pipeline = playGame(seed, pipelinePolicy(kWeights, options), 300);
+        EXPECT_EQ(pipeline.pieces_placed, greedy.pieces_placed);
+        EXPECT_EQ(pipeline.lines_cleared, greedy.lines_cleared);
+        EXPECT_EQ(pipeline.score, greedy.score);
+    }
+}
+
+TEST(CandidatePipeline, KeepsTheBestEstimates)
+{
+    PipelineOptions options;
+    options.keep = 3;
+    CandidatePipeline pipeline(kWeights, featureScore, options);
+    for (const TetrisBoard &board : randomBoards(50, 11))
+    {
+        const PieceOrientationTable &table = kStandardPieces[kPieceL];
+        std::array<Placement, kMaxPlacements> placements;
+        size_t count = enumeratePlacements(board, table.pieces[0], placements);
+        std::vector<float> estimates;
+        for (size_t placement_idx = 0; placement_idx < count; placement_idx++)
+        {
+            const TetrisPiece &piece = table.pieces[placements[placement_idx].orientation];
+            estimates.push_back(scoreFeatures(estimateFeatures(board, piece, placements[placement_idx]), kWeights));
+        }
+        std::sort(estimates.begin(), estimates.end(), std::greater<>());
+
+        std::array<ScoredCandidate, kMaxPlacements> survivors;
+        size_t kept = pipeline.survivors(board, table.pieces[0], survivors);
+        ASSERT_EQ(kept, std::min(count, options.keep));
+        for (size_t survivor_idx = 0; survivor_idx < kept; survivor_idx++)
+        {
+            EXPECT_GE(survivors[survivor_idx].estimate, estimates[kept - 1]);
+            if (survivor_idx > 0)
+            {
+                // Still in enumeration order
+                const Placement &previous = survivors[survivor_idx - 1].placement;
+                const Placement &current = survivors[survivor_idx].placement;
+                EXPECT_TRUE(previous.orientation < current.orientation ||
+                            (previous.orientation == current.orientation && previous.column < current.column));
+            }
+        }
+    }
+
+    std::array<ScoredCandidate, kMaxPlacements - 1> small;
+    EXPECT_THROW(pipeline.survivors(TetrisBoard{}, TetrisPiece::createTPiece(), small), std::invalid_argument);
+}
+
+TEST(CandidatePipeline, CountsEachStage)
+{
+    size_t evaluations = 0;
+    PipelineOptions options;
+    options.keep = 5;
+    CandidatePipeline pipeline(kWeights, [&evaluations](const TetrisBoard &board, int lines_cleared)
+                               {
+        evaluations++;
+        return featureScore(board, lines_cleared); },
+                               options);
+
+    std::vector<TetrisBoard> boards = randomBoards(40, 5);
+    for (const TetrisBoard &board : boards)
+    {
+        std::optional<ScoredCandidate> best = pipeline.best(board, TetrisPiece::createTPiece());
+        if (best)
+        {
+            TetrisBoard child = board;
+            TetrisPiece piece = TetrisPiece::createTPiece();
+            piece.setOrientation(best->placement.orientation);
+            int cleared = child.addPiece(piece, best->placement.column);
+            EXPECT_DOUBLE_EQ(best->score, featureScore(child, cleared));
+        }
+    }
+
+    const PipelineCounters &counters = pipeline.counters();
+    EXPECT_GT(counters.enumerated, 0u);
+    EXPECT_EQ(counters.estimated, counters.enumerated);
+    EXPECT_EQ(counters.pruned + counters.evaluated, counters.enumerated);
+    EXPECT_LE(counters.evaluated, boards.size() * options.keep);
+    EXPECT_EQ(counters.evaluated, evaluations);
+
+    pipeline.resetCounters();
+    EXPECT_EQ(pipeline.counters().enumerated, 0u);
+    EXPECT_EQ(pipeline.counters().evaluated, 0u);
+
+    PipelineOptions exhaustive;
+    exhaustive.prune = false;
+    CandidatePipeline full(kWeights, featureScore, exhaustive);
+    for (const TetrisBoard &board : boards)
+    {
+        full.best(board, TetrisPiece::createTPiece());
+    }
+    EXPECT_EQ(full.counters().estimated, 0u);
+    EXPECT_EQ(full.counters().pruned, 0u);
+    EXPECT_EQ(full.counters().evaluated, full.counters().enumerated);
+}
+
+TEST(CandidatePipeline, PrunedPolicyStillClearsLines)
+{
+    GameResult greedy = playGame(9, greedyPolicy(kWeights), 500);
+    GameResult pruned = playGame(9, pipelinePolicy(kWeights), 500);
+    EXPECT_EQ(pruned.pieces_placed, 500u);
+    EXPECT_GT(pruned.lines_cleared * 10, greedy.lines_cleared * 8);
+}
@@ -0,0 +1,139 @@
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "tetris/evaluation.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+    const FeatureWeights kWeights{-0.51f, -0.18f, -0.36f, 0.76f, -0.05f};
+
+    // Fill a batch with boards from a reproducible random game
+    std::vector<TetrisBoard> randomBoards(size_t count, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::vector<TetrisPiece> pieces;
+        for (const auto &[name, factory] : TetrisPiece::pieceFactories)
+        {
+            pieces.push_back(factory());
+        }
+
+        std::vector<TetrisBoard> boards;
+        TetrisBoard board;
+        while (boards.size() < count)
+        {
+            TetrisPiece piece = pieces[rng() % pieces.size()];
+            piece.setOrientation(rng() % kOrientationCount);
+            int col_offset = rng() % (TetrisBoard::width - piece.width + 1);
+            if (board.landingRow(piece, col_offset) + piece.height > TetrisBoard::height)
+            {
+                board = TetrisBoard{};
+            }
+            board.addPiece(piece, col_offset);
+            boards.push_back(board);
+        }
+        return boards;
+    }
+}
+
+TEST(Evaluation, SingleBoardFeatures)
+{
+    TetrisBoard board;
+    board.addPiece(TetrisPiece{{{true}}}, 1);
+    board.addPiece(TetrisPiece::createTPiece(), 0);
+    BoardFeatures features = computeFeatures(board, 2);
+
+    EXPECT_EQ(features.aggregate_height, 9);
+    EXPECT_EQ(features.bumpiness, 3);
+    EXPECT_EQ(features.holes, 4);
+    EXPECT_EQ(features.completed_lines, 2);
+    EXPECT_EQ(features.max_height, 3);
+}
+
+TEST(Evaluation, BatchImplementationsMatchSingleBoard)
+{
+    std::vector<TetrisBoard> boards = randomBoards(kBatchSize * 50, 7);
+    for (size_t first = 0; first < boards.size(); first += kBatchSize)
+    {
+        BoardBatch batch;
+        for (size_t lane = 0; lane < kBatchSize; lane++)
+        {
+            batch.set(lane, boards[first + lane], static_cast<int>(lane % 3));
+        }
+
+        FeatureBatch scalar;
+        FeatureBatch dispatched;
+        evaluateBatchScalar(batch, kWeights, scalar);
+        evaluateBatch(batch, kWeights, dispatched);
+        for (size_t lane = 0; lane < kBatchSize; lane++)
+        {
+            BoardFeatures expected = computeFeatures(boards[first + lane], static_cast<int>(lane % 3));
+            BoardFeatures actual = dispatched.lane(lane);
+            EXPECT_EQ(actual.aggregate_height, expected.aggregate_height);
+            EXPECT_EQ(actual.bumpiness, expected.bumpiness);
+            EXPECT_EQ(actual.holes, expected.holes);
+            EXPECT_EQ(actual.completed_lines, expected.completed_lines);
+            EXPECT_EQ(actual.max_height, expected.max_height);
+            EXPECT_EQ(dispatched.scores[lane], scoreFeatures(expected, kWeights));
+            EXPECT_EQ(scalar.scores[lane], dispatched.scores[lane]);
+        }
+    }
+}
+
+TEST(Evaluation, Avx2MatchesScalar)
+{
+    if (!avx2Supported())
+    {
+        GTEST_SKIP() << "CPU does not support AVX2";
+    }
+    std::vector<TetrisBoard> boards = randomBoards(kBatchSize, 11);
+    BoardBatch batch;
+    for (size_t lane = 0; lane < kBatchSize; lane++)
+    {
+        batch.set(lane, boards[lane], 1);
+    }
+
+    FeatureBatch scalar;
+    FeatureBatch avx2;
+    evaluateBatchScalar(batch, kWeights, scalar);
+    evaluateBatchAvx2(batch, kWeights, avx2);
+    EXPECT_EQ(scalar.bumpiness, avx2.bumpiness);
+    EXPECT_EQ(scalar.max_height, avx2.max_height);
+    EXPECT_EQ(scalar.scores, avx2.scores);
+}
+
+TEST(Evaluation, ClearedBatchEvaluatesUnusedLanesAsEmpty)
+{
+    std::vector<TetrisBoard> boards = randomBoards(kBatchSize, 5);
+    BoardBatch batch;
+    for (size_t lane = 0; lane < kBatchSize; lane++)
+    {
+        batch.set(lane, boards[lane], 2);
+    }
+
+    // Reuse the batch for fewer boards
+    batch.clear();
+    EXPECT_EQ(batch.count, 0u);
+    batch.set(0, boards[0], 1);
+    batch.set(1, boards[1], 0);
+    EXPECT_EQ(batch.count, 2u);
+
+    FeatureBatch out;
+    evaluateBatch(batch, kWeights, out);
+    EXPECT_EQ(out.scores[0], scoreFeatures(computeFeatures(boards[0], 1), kWeights));
+    EXPECT_EQ(out.scores[1], scoreFeatures(computeFeatures(boards[1], 0), kWeights));
+    float empty_score = scoreFeatures(computeFeatures(TetrisBoard{}, 0), kWeights);
+    for (size_t lane = 2; lane < kBatchSize; lane++)
+    {
+        EXPECT_EQ(out.scores[lane], empty_score);
+        EXPECT_EQ(out.aggregate_height[lane], 0);
+        EXPECT_EQ(out.completed_lines[lane], 0);
+    }
+}
+
+TEST(Evaluation, LaneOutOfRange)
+{
+    BoardBatch batch;
+    EXPECT_THROW(batch.set(kBatchSize, TetrisBoard{}, 0), std::out_of_range);
+}
@@ -4,6 +4,7 @@
 #include <sstream>
 #include <limits>
 #include <string>
+#include <unordered_set>
 
 #include "tetris/piece.h"
 #include "test_pieces.cpp"
@@ -29,15 +30,35 @@ TEST(BasicPiece, ConstructorNonUniformHeight)
     EXPECT_THROW(TetrisPiece piece({{true}, {true, false}}), std::invalid_argument);
 }
 
+TEST(BasicPiece, ConstructorTooLarge)
+{
+    EXPECT_THROW(TetrisPiece piece(Shape(kMaxPieceSize + 1, {true})), std::invalid_argument);
+    EXPECT_THROW(TetrisPiece piece(Shape(1, std::vector<bool>(kMaxPieceSize + 1, true))), std::invalid_argument);
+    EXPECT_NO_THROW(TetrisPiece piece(Shape(kMaxPieceSize, std::vector<bool>(kMaxPieceSize, true))));
+}
+
+TEST(BasicPiece, ValueSemantics)
+{
+    TetrisPiece original = TetrisPiece::createLPiece();
+    TetrisPiece copy = original;
+    copy.rotateClockwise();
+
+    // Mutating a copy must not affect the original
+    EXPECT_EQ(original, TetrisPiece::createLPiece());
+    EXPECT_FALSE(copy == original);
+
+    TetrisPiece moved = std::move(copy);
+    original = moved;
+    EXPECT_EQ(original, moved);
+}
+
 TEST(BasicPiece, FactoryFunctions)
 {
-    EXPECT_NO_THROW({
-        TetrisPiece q_piece = TetrisPiece::createQPiece();
-        TetrisPiece z_piece = TetrisPiece::createZPiece();
-        TetrisPiece t_piece = TetrisPiece::createTPiece();
-        TetrisPiece i_piece = TetrisPiece::createIPiece();
-        TetrisPiece l_piece = TetrisPiece::createLPiece();
-    });
+    EXPECT_NO_THROW(TetrisPiece::createQPiece());
+    EXPECT_NO_THROW(TetrisPiece::createZPiece());
+    EXPECT_NO_THROW(TetrisPiece::createTPiece());
+    EXPECT_NO_THROW(TetrisPiece::createIPiece());
+    EXPECT_NO_THROW(TetrisPiece::createLPiece());
 }
 
 TEST(BasicPiece, FactoryFunctionMap)
@@ -47,6 +68,212 @@ TEST(BasicPiece, FactoryFunctionMap)
     EXPECT_EQ(piece1, piece2);
 }
 
+TEST(BasicPiece, ConstructFromMask)
+{
+    TetrisPiece piece(0x0000000000000306ULL, 3, 2);
+    EXPECT_EQ(piece, TetrisPiece::createZPiece());
+    EXPECT_EQ(piece.skirt, TetrisPiece::createZPiece().skirt);
+    EXPECT_EQ(piece.top, TetrisPiece::createZPiece().top);
+    EXPECT_EQ(piece.orientations, nullptr);
+    EXPECT_THROW(TetrisPiece(0x1, 0, 1), std::invalid_argument);
+    EXPECT_THROW(TetrisPiece(0x1, 1, 9), std::invalid_argument);
+    EXPECT_THROW(TetrisPiece(0x4, 2, 1), std::invalid_argument);
+    EXPECT_THROW(TetrisPiece(0x100, 1, 1), std::invalid_argument);
+}
+
+TEST(BasicPiece, PieceIds)
+{
+    static_assert(pieceIdFromName('T') == kPieceT);
+    for (uint8_t id = 0; id < kStandardPieceCount; id++)
+    {
+        EXPECT_EQ(pieceIdFromName(kPieceNames[id]), id);
+        EXPECT_EQ(TetrisPiece::pieceFactories[static_cast<PieceId>(id)].first, kPieceNames[id]);
+        TetrisPiece piece = TetrisPiece::pieceFactories.at(kPieceNames[id])();
+        EXPECT_EQ(standardPieceId(piece), id);
+        piece.rotateClockwise();
+        EXPECT_EQ(standardPieceId(piece), id);
+    }
+    EXPECT_EQ(standardPieceId(TetrisPiece(0x3, 2, 1)), kStandardPieceCount);
+    EXPECT_THROW(pieceIdFromName('X'), std::out_of_range);
+    EXPECT_THROW(TetrisPiece::pieceFactories.at('\0'), std::out_of_range);
+}
+
+TEST(PieceOrientations, StandardTablesAreConstant)
+{
+    // Every standard orientation, skirt and bounding box is available at compile time
+    static_assert(standardPiece(kPieceQ).orientations == &kStandardPieces[kPieceQ]);
+    static_assert(kStandardPieces[kPieceL].pieces[1].width == 3 && kStandardPieces[kPieceL].pieces[1].height == 2);
+    static_assert(kStandardPieces[kPieceI].distinct_count == 2);
+    static_assert(kStandardPieces[kPieceZ].canonical[2] == 0);
+    static_assert(TetrisPiece::createTPiece().skirt[0] == 1 && TetrisPiece::createTPiece().skirt[1] == 0);
+
+    for (size_t id = 0; id < kStandardPieceCount; id++)
+    {
+        for (const TetrisPiece &piece : kStandardPieces[id].pieces)
+        {
+            EXPECT_EQ(piece.orientations, &kStandardPieces[id]);
+        }
+    }
+}
+
+TEST(PieceOrientations, DistinctOrientationCounts)
+{
+    std::map<char, size_t> expected_counts = {{'Q', 1}, {'Z', 4}, {'T', 4}, {'I', 2}, {'L', 8}};
+    for (const auto &[name, factory] : TetrisPiece::pieceFactories)
+    {
+        TetrisPiece piece = factory();
+        ASSERT_NE(piece.orientations, nullptr) << name;
+        EXPECT_EQ(piece.orientations->distinct_count, expected_counts.at(name)) << name;
+    }
+}
+
+TEST(PieceOrientations, TableMatchesBitwiseTransforms)
+{
+    std::vector<std::function<void(TetrisPiece &)>> transformations = {
+        [](TetrisPiece &p)
+        { p.rotateClockwise(); },
+        [](TetrisPiece &p)
+        { p.rotateCounterClockwise(); },
+        [](TetrisPiece &p)
+        { p.rotate180(); },
+        [](TetrisPiece &p)
+        { p.flipHorizontal(); },
+        [](TetrisPiece &p)
+        { p.flipVertical(); },
+    };
+
+    for (const auto &[name, factory] : TetrisPiece::pieceFactories)
+    {
+        TetrisPiece table_piece = factory();
+        TetrisPiece bitwise_piece = table_piece;
+        bitwise_piece.orientations = nullptr;
+
+        // Walk a long sequence of mixed transformations and check both paths agree at every step
+        for (size_t step = 0; step < 64; step++)
+        {
+            const auto &transformation = transformations[(step * 7 + step / 5) % transformations.size()];
+            transformation(table_piece);
+            transformation(bitwise_piece);
+            ASSERT_EQ(table_piece, bitwise_piece) << name << " step " << step;
+            ASSERT_EQ(table_piece.orientation, bitwise_piece.orientation) << name << " step " << step;
+        }
+    }
+}
+
+TEST(PieceOrientations, SetOrientation)
+{
+    for (const auto &[name, factory] : TetrisPiece::pieceFactories)
+    {
+        TetrisPiece bitwise_piece = factory();
+        bitwise_piece.orientations = nullptr;
+
+        // Visit every orientation from every other orientation
+        for (uint8_t from = 0; from < kOrientationCount; from++)
+        {
+            for (uint8_t to = 0; to < kOrientationCount; to++)
+            {
+                bitwise_piece.setOrientation(from);
+                bitwise_piece.setOrientation(to);
+                EXPECT_EQ(bitwise_piece, factory().orientations->pieces[to]) << name << " " << int(from) << " -> " << int(to);
+                EXPECT_EQ(bitwise_piece.orientation, to);
+            }
+        }
+    }
+    TetrisPiece piece = TetrisPiece::createQPiece();
+    EXPECT_THROW(piece.setOrientation(kOrientationCount), std::out_of_range);
+}
+
+TEST(PieceSymmetries, CanonicalShapes)
+{
+    static_assert(TetrisPiece::createZPiece().canonicalShape(PieceSymmetry::Rotations) == kStandardPieces[kPieceZ].pieces[1].canonicalShape(PieceSymmetry::Rotations));
+
+    for (const auto &[name, factory] : TetrisPiece::pieceFactories)
+    {
+        const PieceOrientationTable &table = *factory().orientations;
+        for (const TetrisPiece &oriented : table.pieces)
+        {
+            // Table-backed and bitwise pieces of the same shape agree
+            TetrisPiece bitwise_piece(oriented.cells, oriented.width, oriented.height);
+            for (PieceSymmetry symmetry : {PieceSymmetry::None, PieceSymmetry::Rotations, PieceSymmetry::RotationsAndReflections})
+            {
+                EXPECT_EQ(oriented.canonicalShape(symmetry), bitwise_piece.canonicalShape(symmetry)) << name;
+                EXPECT_EQ(oriented.canonicalHash(symmetry), bitwise_piece.canonicalHash(symmetry)) << name;
+            }
+
+            for (const TetrisPiece &other : table.pieces)
+            {
+                bool same_flip = (oriented.orientation & 4) == (other.orientation & 4);
+                EXPECT_TRUE(oriented.equivalent(other, PieceSymmetry::RotationsAndReflections)) << name;
+                EXPECT_TRUE(bitwise_piece.equivalent(other, PieceSymmetry::RotationsAndReflections)) << name;
+                if (same_flip)
+                {
+                    EXPECT_TRUE(bitwise_piece.equivalent(other, PieceSymmetry::Rotations)) << name;
+                }
+                EXPECT_EQ(oriented.equivalent(other, PieceSymmetry::None), oriented == other) << name;
+            }
+        }
+    }
+
+    // L is chiral, so its mirror image is only the same piece once reflections are allowed
+    TetrisPiece l_piece = TetrisPiece::createLPiece();
+    TetrisPiece mirrored = l_piece;
+    mirrored.flipHorizontal();
+    EXPECT_FALSE(l_piece.equivalent(mirrored, PieceSymmetry::Rotations));
+    EXPECT_TRUE(l_piece.equivalent(mirrored, PieceSymmetry::RotationsAndReflections));
+    EXPECT_FALSE(l_piece.equivalent(TetrisPiece::createTPiece(), PieceSymmetry::RotationsAndReflections));
+}
+
+TEST(PieceSymmetries, DeduplicateTetrominoes)
+{
+    // Every connected set of four cells in a 4x4 box, packed against row and column zero
+    std::vector<TetrisPiece> fixed;
+    for (uint32_t subset = 0; subset < (1 << 16); subset++)
+    {
+        if (std::popcount(subset) != 4)
+        {
+            continue;
+        }
+        uint64_t cells = 0;
+        int width = 0;
+        int height = 0;
+        for (int cell_idx = 0; cell_idx < 16; cell_idx++)
+        {
+            if (subset & (1 << cell_idx))
+            {
+                cells |= uint64_t{1} << ((cell_idx / 4) * kMaxPieceSize + cell_idx % 4);
+                width = std::max(width, cell_idx % 4 + 1);
+                height = std::max(height, cell_idx / 4 + 1);
+            }
+        }
+        if ((cells & kPieceColumnMask) == 0 || (cells & 0xFF) == 0)
+        {
+            continue;
+        }
+        uint64_t reached = cells & (~cells + 1);
+        for (int step = 0; step < 4; step++)
+        {
+            reached |= ((reached << 1) & ~kPieceColumnMask) | ((reached >> 1) & ~(kPieceColumnMask << 7)) | (reached << 8) | (reached >> 8);
+            reached &= cells;
+        }
+        if (reached == cells)
+        {
+            fixed.emplace_back(cells, width, height);
+        }
+    }
+    ASSERT_EQ(fixed.size(), 19u);
+
+    std::unordered_set<TetrisPiece> exact(fixed.begin(), fixed.end());
+    std::unordered_set<TetrisPiece, PieceHash<PieceSymmetry::Rotations>, PieceEquivalent<PieceSymmetry::Rotations>> one_sided(fixed.begin(), fixed.end());
+    std::unordered_set<TetrisPiece, PieceHash<PieceSymmetry::RotationsAndReflections>, PieceEquivalent<PieceSymmetry::RotationsAndReflections>> free_pieces(fixed.begin(), fixed.end());
+    EXPECT_EQ(exact.size(), 19u);
+    EXPECT_EQ(one_sided.size(), 7u);
+    EXPECT_EQ(free_pieces.size(), 5u);
+    for (size_t id = 0; id < kStandardPieceCount; id++)
+    {
+        EXPECT_EQ(free_pieces.count(standardPiece(static_cast<PieceId>(id))), 1u);
+    }
+}
+
 TEST(BasicPiece, EdgeCaseOneColumnOneRow)
 {
     TetrisPiece piece{{{true}}};
@@ -81,6 +308,32 @@ TEST(BasicPiece, LowestBlockEmptyColumn)
     EXPECT_EQ(piece.lowestBlockInColumn(1), std::numeric_limits<size_t>::max());
 }
 
+TEST(BasicPiece, SkirtAndTopProfile)
+{
+    TetrisPiece piece{{{false, true, false}, {true, false, true}, {false, false, false}}};
+
+    EXPECT_EQ(piece.skirt[0], 1);
+    EXPECT_EQ(piece.skirt[1], 0);
+    EXPECT_EQ(piece.skirt[2], kNoBlock);
+    EXPECT_EQ(piece.top[0], 2);
+    EXPECT_EQ(piece.top[1], 3);
+    EXPECT_EQ(piece.top[2], 0);
+
+    // The profile follows the piece through transformations
+    piece.rotate180();
+    EXPECT_EQ(piece.skirt[0], kNoBlock);
+    EXPECT_EQ(piece.skirt[1], 0);
+    EXPECT_EQ(piece.skirt[2], 1);
+    EXPECT_EQ(piece.top[2], 2);
+}
+
+TEST(BasicPiece, LowestBlockOutOfRange)
+{
+    TetrisPiece piece{{{true, false}, {false, true}}};
+
+    EXPECT_THROW(piece.lowestBlockInColumn(2), std::out_of_range);
+}
+
 TEST(BasicPiece, StreamOperator)
 {
     TetrisPiece piece{{{true}}};
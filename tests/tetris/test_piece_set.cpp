@@ -0,0 +1,186 @@
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+
+#include "tetris/piece_set.h"
+#include "tetris/placement.h"
+#include "tetris/simulator.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+    const std::string kPentominoes = R"(# The twelve free pentominoes
+piece F
+_XX
+XX_
+_X_
+
+piece I
+XXXXX
+
+piece L
+X_
+X_
+X_
+XX
+
+piece N
+_X
+XX
+X_
+X_
+
+piece P
+XX
+XX
+X_
+
+piece T
+XXX
+_X_
+_X_
+
+piece U
+X_X
+XXX
+
+piece V
+X__
+X__
+XXX
+
+piece W
+X__
+XX_
+_XX
+
+piece X
+_X_
+XXX
+_X_
+
+piece Y
+_X
+XX
+_X
+_X
+
+piece Z
+XX_
+_X_
+_XX
+)";
+
+    PieceSet parseString(const std::string &text)
+    {
+        std::istringstream in(text);
+        return PieceSet::parse(in);
+    }
+}
+
+TEST(PieceSet, StandardSetMatchesPieceIds)
+{
+    const PieceSet &standard = PieceSet::standard();
+    ASSERT_EQ(standard.size(), kStandardPieceCount);
+    for (uint8_t id = 0; id < kStandardPieceCount; id++)
+    {
+        EXPECT_EQ(standard.name(id), kPieceNames[id]);
+        EXPECT_EQ(&standard.piece(id), &standardPiece(static_cast<PieceId>(id)));
+        EXPECT_EQ(standard.indexOf(kPieceNames[id]), id);
+    }
+    EXPECT_EQ(standard.indexOf(TetrisPiece::createZPiece()), kPieceZ);
+    EXPECT_EQ(standard.indexOf(TetrisPiece(0x1, 1, 1)), PieceSet::npos);
+    EXPECT_THROW(standard.indexOf('F'), std::out_of_range);
+}
+
+TEST(PieceSet, ParsesPentominoes)
+{
+    PieceSet pentominoes = parseString(kPentominoes);
+    ASSERT_EQ(pentominoes.size(), 12u);
+
+    std::map<char, size_t> expected_counts = {{'F', 8}, {'I', 2}, {'L', 8}, {'N', 8}, {'P', 8}, {'T', 4},
+                                              {'U', 4}, {'V', 4}, {'W', 4}, {'X', 1}, {'Y', 8}, {'Z', 4}};
+    for (size_t piece_idx = 0; piece_idx < pentominoes.size(); piece_idx++)
+    {
+        const TetrisPiece &piece = pentominoes.piece(piece_idx);
+        ASSERT_NE(piece.orientations, nullptr);
+        EXPECT_EQ(piece.orientations->distinct_count, expected_counts.at(pentominoes.name(piece_idx))) << pentominoes.name(piece_idx);
+        EXPECT_EQ(std::popcount(piece.cells), 5);
+        EXPECT_EQ(pentominoes.indexOf(piece), piece_idx);
+
+        // Turning a loaded piece is a table lookup, just like the standard pieces
+        TetrisPiece turned = piece;
+        turned.rotateClockwise();
+        EXPECT_EQ(turned.orientations, piece.orientations);
+        EXPECT_EQ(turned, piece.orientations->pieces[1]);
+    }
+
+    // Rows are listed top to bottom
+    const TetrisPiece &f_piece = pentominoes.piece(pentominoes.indexOf('F'));
+    EXPECT_EQ(f_piece.cells, 0x0000000000060302ULL);
+    EXPECT_EQ(f_piece.width, 3);
+    EXPECT_EQ(f_piece.height, 3);
+}
+
+TEST(PieceSet, RejectsInvalidPieces)
+{
+    // Disconnected
+    EXPECT_THROW(parseString("piece A\nX_X\n"), std::invalid_argument);
+    // Only touching at a corner
+    EXPECT_THROW(parseString("piece A\nX_\n_X\n"), std::invalid_argument);
+    // Empty column on the border
+    EXPECT_THROW(parseString("piece A\nXX_\n"), std::invalid_argument);
+    // Empty row on the border
+    EXPECT_THROW(parseString("piece A\n__\nXX\n"), std::invalid_argument);
+    // Too large
+    EXPECT_THROW(parseString("piece A\nXXXXXXXXX\n"), std::invalid_argument);
+    // Ragged rows
+    EXPECT_THROW(parseString("piece A\nXX\nX\n"), std::invalid_argument);
+    // Bad cell character
+    EXPECT_THROW(parseString("piece A\nXO\n"), std::invalid_argument);
+    // Rows before any header
+    EXPECT_THROW(parseString("XX\n"), std::invalid_argument);
+    // Bad name
+    EXPECT_THROW(parseString("piece AB\nXX\n"), std::invalid_argument);
+    // Header without rows
+    EXPECT_THROW(parseString("piece A\n\npiece B\nX\n"), std::invalid_argument);
+}
+
+TEST(PieceSet, RejectsDuplicates)
+{
+    EXPECT_THROW(parseString("piece A\nXX\n\npiece A\nX\n"), std::invalid_argument);
+    // The same S shape, mirrored and turned
+    EXPECT_THROW(parseString("piece S\n_XX\nXX_\n\npiece Z\nX_\nXX\n_X\n"), std::invalid_argument);
+
+    PieceSet set;
+    EXPECT_EQ(set.add('O', TetrisPiece::createQPiece()), 0u);
+    EXPECT_THROW(set.add('Q', TetrisPiece(0x0303, 2, 2)), std::invalid_argument);
+}
+
+TEST(PieceSet, LoadMissingFile)
+{
+    EXPECT_THROW(PieceSet::load("/nonexistent/pieces.txt"), std::runtime_error);
+}
+
+TEST(PieceSet, CustomSetPlaysGames)
+{
+    PieceSet pentominoes = parseString(kPentominoes);
+    PieceGenerator generator(5, pentominoes);
+    for (int bag_idx = 0; bag_idx < 10; bag_idx++)
+    {
+        std::set<size_t> seen;
+        for (size_t idx = 0; idx < pentominoes.size(); idx++)
+        {
+            seen.insert(pentominoes.indexOf(generator.next()));
+        }
+        EXPECT_EQ(seen.size(), pentominoes.size());
+    }
+
+    Policy policy = greedyPolicy(FeatureWeights{-0.51f, -0.18f, -0.36f, 0.76f, -0.05f});
+    GameResult result = playGame(3, policy, 200, nullptr, pentominoes);
+    GameResult repeat = playGame(3, policy, 200, nullptr, pentominoes);
+    EXPECT_GT(result.pieces_placed, 20u);
+    EXPECT_EQ(result.pieces_placed, repeat.pieces_placed);
+    EXPECT_EQ(result.score, repeat.score);
+}
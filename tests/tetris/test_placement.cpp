@@ -0,0 +1,90 @@
+#include <array>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+#include "tetris/placement.h"
+#include <gtest/gtest.h>
+
+TEST(Placements, EmptyBoardCounts)
+{
+    std::map<char, size_t> expected_counts = {{'Q', 9}, {'Z', 34}, {'T', 34}, {'I', 17}, {'L', 68}};
+    TetrisBoard board;
+    std::array<Placement, kMaxPlacements> placements;
+
+    for (const auto &[name, factory] : TetrisPiece::pieceFactories)
+    {
+        EXPECT_EQ(enumeratePlacements(board, factory(), placements), expected_counts.at(name)) << name;
+    }
+}
+
+TEST(Placements, PiecesWithoutTableMatchTable)
+{
+    TetrisBoard board;
+    board.addPiece(TetrisPiece::createLPiece(), 3);
+    board.addPiece(TetrisPiece::createZPiece(), 6);
+    std::array<Placement, kMaxPlacements> from_table;
+    std::array<Placement, kMaxPlacements> from_bits;
+
+    for (const auto &[name, factory] : TetrisPiece::pieceFactories)
+    {
+        TetrisPiece piece = factory();
+        TetrisPiece bitwise_piece = piece;
+        bitwise_piece.orientations = nullptr;
+
+        size_t table_count = enumeratePlacements(board, piece, from_table);
+        size_t bits_count = enumeratePlacements(board, bitwise_piece, from_bits);
+        ASSERT_EQ(table_count, bits_count) << name;
+        for (size_t idx = 0; idx < table_count; idx++)
+        {
+            EXPECT_EQ(from_table[idx], from_bits[idx]) << name << " placement " << idx;
+        }
+    }
+}
+
+TEST(Placements, PlacementsMatchAddPiece)
+{
+    TetrisBoard board;
+    board.addPiece(TetrisPiece::createTPiece(), 0);
+    TetrisPiece piece = TetrisPiece::createLPiece();
+    piece.rotateClockwise();
+    std::array<Placement, kMaxPlacements> placements;
+    size_t count = enumeratePlacements(board, piece, placements);
+
+    for (size_t idx = 0; idx < count; idx++)
+    {
+        TetrisPiece oriented = piece;
+        oriented.setOrientation(placements[idx].orientation);
+        EXPECT_EQ(board.landingRow(oriented, placements[idx].column), placements[idx].row);
+        TetrisBoard copy = board;
+        EXPECT_NO_THROW(copy.addPiece(oriented, placements[idx].column));
+    }
+}
+
+TEST(Placements, SkipsPlacementsAboveBoard)
+{
+    TetrisBoard board;
+    TetrisPiece tower{{{true, true, true, true, true, true, true, true}}};
+    for (int drop = 0; drop < 3; drop++)
+    {
+        board.addPiece(tower, 0);
+    }
+    board.addPiece(TetrisPiece{{{true, true, true}}}, 0);
+    std::array<Placement, kMaxPlacements> placements;
+    size_t count = enumeratePlacements(board, TetrisPiece::createIPiece(), placements);
+
+    // Vertical I pieces no longer fit in column 0, every other placement does
+    EXPECT_EQ(count, 16);
+    for (size_t idx = 0; idx < count; idx++)
+    {
+        EXPECT_FALSE(placements[idx].column == 0 && placements[idx].orientation == 1);
+    }
+}
+
+TEST(Placements, BufferTooSmall)
+{
+    TetrisBoard board;
+    std::vector<Placement> placements(kMaxPlacements - 1);
+
+    EXPECT_THROW(enumeratePlacements(board, TetrisPiece::createQPiece(), placements), std::invalid_argument);
+}
@@ -0,0 +1,414 @@
+#include <algorithm>
+#include <array>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "tetris/reachability.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+    using PlacementKey = std::tuple<int, int, int>;
+
+    std::set<PlacementKey> keysOf(std::span<const ReachablePlacement> placements)
+    {
+        std::set<PlacementKey> keys;
+        for (const ReachablePlacement &reachable : placements)
+        {
+            keys.emplace(reachable.placement.orientation, reachable.placement.column, reachable.placement.row);
+        }
+        return keys;
+    }
+
+    // Play inputs from the spawn position, following the documented rotation and kick rules, and return where the piece locks
+    Placement replay(const TetrisBoard &board, TetrisPiece piece, std::span<const Input> inputs)
+    {
+        int column = (TetrisBoard::width - piece.width) / 2;
+        int row = TetrisBoard::height - piece.height;
+        for (Input input : inputs)
+        {
+            switch (input)
+            {
+            case Input::Left:
+                EXPECT_FALSE(board.collides(piece, column - 1, row));
+                column--;
+                break;
+            case Input::Right:
+                EXPECT_FALSE(board.collides(piece, column + 1, row));
+                column++;
+                break;
+            case Input::SoftDrop:
+                EXPECT_FALSE(board.collides(piece, column, row - 1));
+                row--;
+                break;
+            case Input::RotateClockwise:
+            case Input::RotateCounterClockwise:
+            {
+                TetrisPiece turned = piece;
+                input == Input::RotateClockwise ? turned.rotateClockwise() : turned.rotateCounterClockwise();
+                int turned_column = column + (piece.width - turned.width) / 2;
+                int turned_row = row + (piece.height - turned.height) / 2;
+                bool kicked = false;
+                for (const Kick &kick : kDefaultKicks)
+                {
+                    if (!board.collides(turned, turned_column + kick.columns, turned_row + kick.rows))
+                    {
+                        column = turned_column + kick.columns;
+                        row = turned_row + kick.rows;
+                        kicked = true;
+                        break;
+                    }
+                }
+                EXPECT_TRUE(kicked);
+                piece = turned;
+                break;
+            }
+            case Input::HardDrop:
+                while (!board.collides(piece, column, row - 1))
+                {
+                    row--;
+                }
+                return Placement{piece.orientation, static_cast<uint8_t>(column), static_cast<uint8_t>(row)};
+            }
+        }
+        ADD_FAILURE() << "Input sequence does not end with a hard drop";
+        return Placement{};
+    }
+
+    bool tCell(const TetrisPiece &piece, int col_idx, int row_idx)
+    {
+        return col_idx >= 0 && row_idx >= 0 && col_idx < piece.width && row_idx < piece.height &&
+               ((piece.cells >> (row_idx * kMaxPieceSize + col_idx)) & 1);
+    }
+
+    // Three corner rule for a T resting at the given position, written independently of the search
+    SpinType referenceSpin(const TetrisBoard &board, const TetrisPiece &piece, int column, int row)
+    {
+        auto filled = [&](int col_idx, int row_idx)
+        {
+            if (col_idx < 0 || col_idx >= TetrisBoard::width || row_idx < 0)
+            {
+                return true;
+            }
+            return row_idx < TetrisBoard::height && board.at(col_idx, row_idx);
+        };
+        for (int col_idx = 0; col_idx < piece.width; col_idx++)
+        {
+            for (int row_idx = 0; row_idx < piece.height; row_idx++)
+            {
+                bool left = tCell(piece, col_idx - 1, row_idx);
+                bool right = tCell(piece, col_idx + 1, row_idx);
+                bool down = tCell(piece, col_idx, row_idx - 1);
+                bool up = tCell(piece, col_idx, row_idx + 1);
+                if (!tCell(piece, col_idx, row_idx) || left + right + down + up != 3)
+                {
+                    continue;
+                }
+                int centre_col = column + col_idx;
+                int centre_row = row + row_idx;
+                int corners = filled(centre_col - 1, centre_row - 1) + filled(centre_col + 1, centre_row - 1) +
+                              filled(centre_col - 1, centre_row + 1) + filled(centre_col + 1, centre_row + 1);
+                // The corners on the side the nub points to
+                bool front_filled;
+                if (!left || !right)
+                {
+                    int side = left ? -1 : 1;
+                    front_filled = filled(centre_col + side, centre_row - 1) && filled(centre_col + side, centre_row + 1);
+                }
+                else
+                {
+                    int side = down ? -1 : 1;
+                    front_filled = filled(centre_col - 1, centre_row + side) && filled(centre_col + 1, centre_row + side);
+                }
+                if (corners < 3)
+                {
+                    return SpinType::None;
+                }
+                return front_filled ? SpinType::Full : SpinType::Mini;
+            }
+        }
+        return SpinType::None;
+    }
+
+    using LockKey = std::tuple<int, int, int, SpinType>;
+
+    // Every way a T can lock, found by a plain breadth first search over piece positions with collides. Every arrival at a position
+    // counts, not just the first, so a slot reached both by sliding and by rotating locks both with and without a spin.
+    std::set<LockKey> referenceTLocks(const TetrisBoard &board)
+    {
+        struct Position
+        {
+            TetrisPiece piece;
+            int column;
+            int row;
+        };
+        std::set<LockKey> locks;
+        std::set<std::tuple<int, int, int>> seen;
+        std::vector<Position> queue;
+        auto arrive = [&](const Position &position, bool rotated)
+        {
+            int rest = position.row;
+            while (!board.collides(position.piece, position.column, rest - 1))
+            {
+                rest--;
+            }
+            SpinType spin = rotated && rest == position.row ? referenceSpin(board, position.piece, position.column, rest) : SpinType::None;
+            locks.emplace(position.piece.orientation, position.column, rest, spin);
+            if (seen.emplace(position.piece.orientation, position.column, position.row).second)
+            {
+                queue.push_back(position);
+            }
+        };
+
+        TetrisPiece spawn = TetrisPiece::createTPiece();
+        Position start{spawn, (TetrisBoard::width - spawn.width) / 2, TetrisBoard::height - spawn.height};
+        if (board.collides(start.piece, start.column, start.row))
+        {
+            return locks;
+        }
+        arrive(start, false);
+        for (size_t head = 0; head < queue.size(); head++)
+        {
+            Position position = queue[head];
+            for (auto [columns, rows] : {std::pair{-1, 0}, std::pair{1, 0}, std::pair{0, -1}})
+            {
+                if (!board.collides(position.piece, position.column + columns, position.row + rows))
+                {
+                    arrive(Position{position.piece, position.column + columns, position.row + rows}, false);
+                }
+            }
+            for (bool clockwise : {true, false})
+            {
+                TetrisPiece turned = position.piece;
+                clockwise ? turned.rotateClockwise() : turned.rotateCounterClockwise();
+                int turned_column = position.column + (position.piece.width - turned.width) / 2;
+                int turned_row = position.row + (position.piece.height - turned.height) / 2;
+                for (const Kick &kick : kDefaultKicks)
+                {
+                    if (!board.collides(turned, turned_column + kick.columns, turned_row + kick.rows))
+                    {
+                        arrive(Position{turned, turned_column + kick.columns, turned_row + kick.rows}, true);
+                        break;
+                    }
+                }
+            }
+        }
+        return locks;
+    }
+}
+
+TEST(Reachability, EmptyBoardMatchesHardDrops)
+{
+    ReachabilitySearch search;
+    std::vector<ReachablePlacement> reachable(ReachabilitySearch::kMaxReachable);
+    std::array<Placement, kMaxPlacements> dropped;
+    TetrisBoard board;
+    for (const auto &[name, factory] : TetrisPiece::pieceFactories)
+    {
+        // Every straight drop of the unmirrored orientations, and nothing else, is reachable on an empty board
+        size_t count = search.search(board, factory(), reachable);
+        std::set<PlacementKey> expected;
+        size_t dropped_count = enumeratePlacements(board, factory(), dropped);
+        for (size_t placement_idx = 0; placement_idx < dropped_count; placement_idx++)
+        {
+            if (dropped[placement_idx].orientation < 4)
+            {
+                expected.emplace(dropped[placement_idx].orientation, dropped[placement_idx].column, dropped[placement_idx].row);
+            }
+        }
+        EXPECT_EQ(keysOf(std::span(reachable).first(count)), expected) << name;
+        EXPECT_EQ(count, expected.size()) << name;
+
+        // Results come out in order of input count
+        for (size_t placement_idx = 1; placement_idx < count; placement_idx++)
+        {
+            EXPECT_LE(reachable[placement_idx - 1].input_count, reachable[placement_idx].input_count);
+        }
+    }
+}
+
+TEST(Reachability, TucksUnderOverhangs)
+{
+    // A roof over the three left columns, two rows up
+    std::array<TetrisBoard::Row, TetrisBoard::height> rows{};
+    rows[2] = 0b111;
+    TetrisBoard board{std::span<const TetrisBoard::Row>(rows)};
+    ReachabilitySearch search;
+    std::vector<ReachablePlacement> reachable(ReachabilitySearch::kMaxReachable);
+    size_t count = search.search(board, TetrisPiece::createQPiece(), reachable);
+
+    auto tucked = std::find_if(reachable.begin(), reachable.begin() + count, [](const ReachablePlacement &r)
+                               { return r.placement == Placement{0, 0, 0}; });
+    ASSERT_NE(tucked, reachable.begin() + count);
+    std::array<Placement, kMaxPlacements> dropped;
+    size_t dropped_count = enumeratePlacements(board, TetrisPiece::createQPiece(), dropped);
+    EXPECT_EQ(std::count(dropped.begin(), dropped.begin() + dropped_count, Placement{0, 0, 0}), 0);
+
+    // Spawn at column 4, drop to the floor beside the roof and slide under it
+    std::vector<Input> inputs(tucked->input_count);
+    ASSERT_EQ(search.inputs(*tucked, inputs), tucked->input_count);
+    EXPECT_EQ(inputs.back(), Input::HardDrop);
+    EXPECT_EQ(std::count(inputs.begin(), inputs.end(), Input::Left), 4);
+    EXPECT_EQ(replay(board, TetrisPiece::createQPiece(), inputs), tucked->placement);
+}
+
+TEST(Reachability, InputsReplayOnRandomBoards)
+{
+    std::mt19937 rng(77);
+    ReachabilitySearch search;
+    std::vector<ReachablePlacement> reachable(ReachabilitySearch::kMaxReachable);
+    std::vector<Input> inputs(ReachabilitySearch::kMaxStates + 1);
+    for (int trial = 0; trial < 20; trial++)
+    {
+        // Ragged stacks with scattered holes and overhangs
+        std::array<TetrisBoard::Row, TetrisBoard::height> rows{};
+        for (int row_idx = 0; row_idx < 12; row_idx++)
+        {
+            rows[row_idx] = static_cast<TetrisBoard::Row>(rng() & rng() & TetrisBoard::kFullRow);
+        }
+        TetrisBoard board{std::span<const TetrisBoard::Row>(rows)};
+        for (const auto &[name, factory] : TetrisPiece::pieceFactories)
+        {
+            size_t count = search.search(board, factory(), reachable);
+            for (size_t placement_idx = 0; placement_idx < count; placement_idx++)
+            {
+                const ReachablePlacement &placement = reachable[placement_idx];
+                size_t input_count = search.inputs(placement, inputs);
+                Placement locked = replay(board, factory(), std::span(inputs).first(input_count));
+                TetrisPiece reported = factory();
+                reported.setOrientation(placement.placement.orientation);
+                TetrisPiece replayed = factory();
+                replayed.setOrientation(locked.orientation);
+                ASSERT_EQ(reported, replayed) << name;
+                ASSERT_EQ(locked.column, placement.placement.column) << name;
+                ASSERT_EQ(locked.row, placement.placement.row) << name;
+                EXPECT_FALSE(board.collides(reported, locked.column, locked.row));
+                EXPECT_TRUE(board.collides(reported, locked.column, locked.row - 1));
+            }
+        }
+    }
+}
+
+TEST(Reachability, DetectsTSpins)
+{
+    // A T-spin double slot under a one cell roof:
+    // X_________
+    // ___XXXXXXX
+    // X_XXXXXXXX
+    std::array<TetrisBoard::Row, TetrisBoard::height> rows{};
+    rows[0] = TetrisBoard::kFullRow & ~0b10;
+    rows[1] = TetrisBoard::kFullRow & ~0b111;
+    rows[2] = 0b1;
+    TetrisBoard board{std::span<const TetrisBoard::Row>(rows)};
+    ReachabilitySearch search;
+    std::vector<ReachablePlacement> reachable(ReachabilitySearch::kMaxReachable);
+    size_t count = search.search(board, TetrisPiece::createTPiece(), reachable);
+
+    auto spin = std::find_if(reachable.begin(), reachable.begin() + count, [](const ReachablePlacement &r)
+                             { return r.placement == Placement{0, 0, 0}; });
+    ASSERT_NE(spin, reachable.begin() + count);
+    EXPECT_EQ(spin->spin, SpinType::Full);
+    std::vector<Input> inputs(spin->input_count);
+    search.inputs(*spin, inputs);
+    Input last_move = inputs[inputs.size() - 2];
+    EXPECT_TRUE(last_move == Input::RotateClockwise || last_move == Input::RotateCounterClockwise);
+    EXPECT_EQ(replay(board, TetrisPiece::createTPiece(), inputs), spin->placement);
+
+    // Other pieces never spin
+    count = search.search(board, TetrisPiece::createLPiece(), reachable);
+    EXPECT_TRUE(std::all_of(reachable.begin(), reachable.begin() + count, [](const ReachablePlacement &r)
+                            { return r.spin == SpinType::None; }));
+}
+
+TEST(Reachability, ReportsSpinsIntoSlotsAlsoReachedBySliding)
+{
+    // A T can slide left along the floor into the corner beside this cell, or rotate into the same spot against the wall. Only the
+    // rotation locks as a mini spin.
+    // _X________
+    std::array<TetrisBoard::Row, TetrisBoard::height> rows{};
+    rows[0] = 0b10;
+    TetrisBoard board{std::span<const TetrisBoard::Row>(rows)};
+    ReachabilitySearch search;
+    std::vector<ReachablePlacement> reachable(ReachabilitySearch::kMaxReachable);
+    size_t count = search.search(board, TetrisPiece::createTPiece(), reachable);
+
+    const Placement corner{3, 0, 0};
+    auto plain = std::find_if(reachable.begin(), reachable.begin() + count, [&](const ReachablePlacement &r)
+                              { return r.placement == corner && r.spin == SpinType::None; });
+    auto spin = std::find_if(reachable.begin(), reachable.begin() + count, [&](const ReachablePlacement &r)
+                             { return r.placement == corner && r.spin == SpinType::Mini; });
+    ASSERT_NE(plain, reachable.begin() + count);
+    ASSERT_NE(spin, reachable.begin() + count);
+    // The slide is found first, so a search keeping only the first way into the slot would lose the spin
+    EXPECT_LT(plain->input_count, spin->input_count);
+
+    std::vector<Input> inputs(spin->input_count);
+    search.inputs(*spin, inputs);
+    Input last_move = inputs[inputs.size() - 2];
+    EXPECT_TRUE(last_move == Input::RotateClockwise || last_move == Input::RotateCounterClockwise);
+    EXPECT_EQ(replay(board, TetrisPiece::createTPiece(), inputs), corner);
+    inputs.resize(plain->input_count);
+    search.inputs(*plain, inputs);
+    EXPECT_EQ(replay(board, TetrisPiece::createTPiece(), inputs), corner);
+}
+
+TEST(Reachability, SpinsMatchReferenceOnRandomBoards)
+{
+    std::mt19937 rng(2024);
+    ReachabilitySearch search;
+    std::vector<ReachablePlacement> reachable(ReachabilitySearch::kMaxReachable);
+    std::vector<Input> inputs(ReachabilitySearch::kMaxStates + 1);
+    size_t spins = 0;
+    for (int trial = 0; trial < 300; trial++)
+    {
+        std::array<TetrisBoard::Row, TetrisBoard::height> rows{};
+        for (int row_idx = 0; row_idx < 6; row_idx++)
+        {
+            rows[row_idx] = static_cast<TetrisBoard::Row>(rng() & rng() & TetrisBoard::kFullRow);
+        }
+        TetrisBoard board{std::span<const TetrisBoard::Row>(rows)};
+        size_t count = search.search(board, TetrisPiece::createTPiece(), reachable);
+
+        std::set<LockKey> found;
+        for (size_t placement_idx = 0; placement_idx < count; placement_idx++)
+        {
+            const ReachablePlacement &placement = reachable[placement_idx];
+            found.emplace(placement.placement.orientation, placement.placement.column, placement.placement.row, placement.spin);
+            if (placement.spin != SpinType::None)
+            {
+                spins++;
+                size_t input_count = search.inputs(placement, inputs);
+                Input last_move = inputs[input_count - 2];
+                EXPECT_TRUE(last_move == Input::RotateClockwise || last_move == Input::RotateCounterClockwise);
+            }
+        }
+        ASSERT_EQ(found, referenceTLocks(board)) << "trial " << trial;
+    }
+    EXPECT_GT(spins, 0u);
+}
+
+TEST(Reachability, BlockedSpawnAndSmallBuffers)
+{
+    ReachabilitySearch search;
+    std::vector<ReachablePlacement> reachable(ReachabilitySearch::kMaxReachable);
+    std::vector<ReachablePlacement> small(ReachabilitySearch::kMaxReachable - 1);
+    TetrisBoard board;
+    EXPECT_THROW(search.search(board, TetrisPiece::createIPiece(), small), std::invalid_argument);
+
+    size_t count = search.search(board, TetrisPiece::createIPiece(), reachable);
+    ASSERT_GT(count, 0u);
+    std::vector<Input> inputs(reachable[count - 1].input_count - 1);
+    EXPECT_THROW(search.inputs(reachable[count - 1], inputs), std::invalid_argument);
+
+    std::array<TetrisBoard::Row, TetrisBoard::height> rows{};
+    rows[TetrisBoard::height - 1] = 0b0000110000;
+    for (int row_idx = 0; row_idx < TetrisBoard::height - 1; row_idx++)
+    {
+        rows[row_idx] = 0b1;
+    }
+    EXPECT_EQ(search.search(TetrisBoard{std::span<const TetrisBoard::Row>(rows)}, TetrisPiece::createQPiece(), reachable), 0u);
+}
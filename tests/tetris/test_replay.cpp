@@ -0,0 +1,195 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tetris/replay.h"
+#include "tetris/simulator.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+    const FeatureWeights kWeights{-0.51f, -0.18f, -0.36f, 0.76f, -0.05f};
+
+    // A temporary file removed when the test finishes
+    struct TempFile
+    {
+        std::string path;
+
+        explicit TempFile(const std::string &name)
+            : path(testing::TempDir() + name)
+        {
+        }
+
+        ~TempFile()
+        {
+            std::remove(path.c_str());
+        }
+    };
+}
+
+TEST(ReplayCodec, EveryCodeRoundTrips)
+{
+    ReplayCodec codec;
+    EXPECT_EQ(codec.codeSize(), 1u);
+    for (size_t code = 0; code < codec.codeCount(); code++)
+    {
+        EXPECT_EQ(codec.encode(codec.decode(static_cast<uint16_t>(code))), code);
+    }
+    EXPECT_THROW(codec.decode(static_cast<uint16_t>(codec.codeCount())), std::invalid_argument);
+}
+
+TEST(ReplayCodec, EquivalentOrientationsShareACode)
+{
+    ReplayCodec codec;
+    PieceId q_idx = kPieceQ;
+    for (uint8_t orientation = 0; orientation < kOrientationCount; orientation++)
+    {
+        EXPECT_EQ(codec.encode(ReplayMove{q_idx, orientation, 3}), codec.encode(ReplayMove{q_idx, 0, 3}));
+    }
+    EXPECT_THROW(codec.encode(ReplayMove{q_idx, 0, 9}), std::invalid_argument);
+}
+
+TEST(ReplayCodec, RejectsNonStandardPieces)
+{
+    std::ostringstream out;
+    ReplayWriter writer(out);
+    EXPECT_THROW(writer.record(TetrisPiece(std::vector<std::vector<bool>>{{true}}), Placement{0, 0, 0}), std::invalid_argument);
+}
+
+TEST(Replay, RecordedGameReadsBack)
+{
+    TempFile file("recorded_game.ttr");
+    std::vector<TetrisBoard> boards;
+    std::vector<TetrisPiece> pieces;
+    Policy greedy = greedyPolicy(kWeights);
+    Policy recording = [&](const TetrisBoard &board, const TetrisPiece &piece)
+    {
+        boards.push_back(board);
+        std::optional<Placement> placement = greedy(board, piece);
+        if (placement)
+        {
+            TetrisPiece placed = piece;
+            placed.setOrientation(placement->orientation);
+            pieces.push_back(placed);
+        }
+        return placement;
+    };
+
+    GameResult result;
+    TetrisBoard final_board;
+    {
+        std::ofstream out(file.path, std::ios::binary);
+        ReplayWriter writer(out, 64);
+        result = playGame(11, recording, 1000, &writer);
+        writer.finish();
+        final_board = writer.currentBoard();
+    }
+
+    ReplayReader reader(file.path);
+    ASSERT_EQ(reader.moveCount(), result.pieces_placed);
+    ASSERT_GT(result.pieces_placed, 200u);
+    for (uint64_t move_idx = 0; move_idx < reader.moveCount(); move_idx++)
+    {
+        EXPECT_EQ(reader.piece(move_idx).cells, pieces[move_idx].cells);
+        EXPECT_EQ(reader.boardBefore(move_idx), boards[move_idx]);
+    }
+    EXPECT_EQ(reader.boardBefore(reader.moveCount()), final_board);
+    EXPECT_THROW(reader.move(reader.moveCount()), std::out_of_range);
+}
+
+TEST(Replay, EmptyReplay)
+{
+    TempFile file("empty.ttr");
+    {
+        std::ofstream out(file.path, std::ios::binary);
+        ReplayWriter writer(out);
+    }
+
+    ReplayReader reader(file.path);
+    EXPECT_EQ(reader.moveCount(), 0u);
+    EXPECT_EQ(reader.boardBefore(0), TetrisBoard{});
+}
+
+TEST(Replay, MovesAreOneByteEach)
+{
+    std::ostringstream empty_out;
+    {
+        ReplayWriter writer(empty_out, 1000);
+    }
+    std::ostringstream out;
+    {
+        ReplayWriter writer(out, 1000);
+        writer.record(TetrisPiece::createIPiece(), Placement{0, 0, 0});
+        writer.record(TetrisPiece::createIPiece(), Placement{0, 0, 0});
+        writer.record(TetrisPiece::createQPiece(), Placement{0, 4, 0});
+    }
+    // One board snapshot, three moves and one index entry
+    size_t snapshot_size = TetrisBoard::height * sizeof(TetrisBoard::Row);
+    EXPECT_EQ(out.str().size() - empty_out.str().size(), snapshot_size + 3 + 8);
+}
+
+TEST(Replay, RejectsInvalidFiles)
+{
+    EXPECT_THROW(ReplayReader("/nonexistent/replay.ttr"), std::runtime_error);
+
+    TempFile file("truncated.ttr");
+    std::ostringstream out;
+    {
+        ReplayWriter writer(out);
+        writer.record(TetrisPiece::createTPiece(), Placement{0, 0, 0});
+    }
+    std::string bytes = out.str();
+    {
+        std::ofstream truncated(file.path, std::ios::binary);
+        truncated << bytes.substr(0, bytes.size() - 1);
+    }
+    EXPECT_THROW(ReplayReader{file.path}, std::runtime_error);
+
+    {
+        std::ofstream corrupted(file.path, std::ios::binary);
+        bytes[0] = 'X';
+        corrupted << bytes;
+    }
+    EXPECT_THROW(ReplayReader{file.path}, std::runtime_error);
+}
+
+TEST(Replay, RecordAfterFinishThrows)
+{
+    std::ostringstream out;
+    ReplayWriter writer(out);
+    writer.finish();
+    EXPECT_THROW(writer.record(TetrisPiece::createTPiece(), Placement{0, 0, 0}), std::logic_error);
+}
+
+TEST(Replay, TopOutAtBlockBoundaryKeepsEarlierMoves)
+{
+    TempFile file("top_out.ttr");
+    TetrisBoard before_top_out;
+    {
+        std::ofstream out(file.path, std::ios::binary);
+        ReplayWriter writer(out, 4);
+        // Vertical I pieces in the first column reach the top after the board height divided by four
+        int stacked = TetrisBoard::height / 4;
+        for (int move_idx = 0; move_idx < stacked; move_idx++)
+        {
+            writer.record(TetrisPiece::createIPiece(), Placement{1, 0, 0});
+        }
+        // Fill out a whole block so the next move would start a new one
+        while (stacked % 4 != 0)
+        {
+            writer.record(TetrisPiece::createQPiece(), Placement{0, 4, 0});
+            stacked++;
+        }
+        before_top_out = writer.currentBoard();
+        EXPECT_THROW(writer.record(TetrisPiece::createIPiece(), Placement{1, 0, 0}), std::overflow_error);
+        EXPECT_EQ(writer.currentBoard(), before_top_out);
+        writer.finish();
+    }
+
+    ReplayReader reader(file.path);
+    ASSERT_EQ(reader.moveCount() % 4, 0u);
+    EXPECT_EQ(reader.moveCount(), static_cast<uint64_t>((TetrisBoard::height / 4 + 3) / 4 * 4));
+    EXPECT_EQ(reader.boardBefore(reader.moveCount()), before_top_out);
+}
@@ -0,0 +1,138 @@
+#include <array>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "tetris/search.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+    double flatBoard(const TetrisBoard &board, int lines_cleared)
+    {
+        return lines_cleared * 10.0 - board.maxHeight() - 4.0 * board.holes();
+    }
+
+    // Plain recursive reference search
+    double referenceScore(const TetrisBoard &board, const std::vector<TetrisPiece> &pieces, size_t ply, int lines_cleared)
+    {
+        if (ply == pieces.size())
+        {
+            return flatBoard(board, lines_cleared);
+        }
+        std::array<Placement, kMaxPlacements> placements;
+        size_t count = enumeratePlacements(board, pieces[ply], placements);
+        double best = -std::numeric_limits<double>::infinity();
+        for (size_t idx = 0; idx < count; idx++)
+        {
+            TetrisPiece piece = pieces[ply];
+            piece.setOrientation(placements[idx].orientation);
+            TetrisBoard child = board;
+            int cleared = child.addPiece(piece, placements[idx].column);
+            best = std::max(best, referenceScore(child, pieces, ply + 1, lines_cleared + cleared));
+        }
+        return best;
+    }
+}
+
+TEST(GameTreeSearch, MatchesReferenceSearch)
+{
+    ThreadPool pool(4);
+    GameTreeSearch search(flatBoard, pool);
+    TetrisBoard board;
+    board.addPiece(TetrisPiece::createLPiece(), 0);
+    board.addPiece(TetrisPiece::createZPiece(), 4);
+    std::vector<TetrisPiece> pieces = {TetrisPiece::createTPiece(), TetrisPiece::createIPiece(), TetrisPiece::createQPiece()};
+
+    SearchResult result = search.search(board, pieces);
+    ASSERT_TRUE(result.found);
+    EXPECT_DOUBLE_EQ(result.score, referenceScore(board, pieces, 0, 0));
+
+    // The reported placement must actually lead to the reported score
+    TetrisPiece first = pieces[0];
+    first.setOrientation(result.placement.orientation);
+    TetrisBoard child = board;
+    int cleared = child.addPiece(first, result.placement.column);
+    std::vector<TetrisPiece> rest(pieces.begin() + 1, pieces.end());
+    EXPECT_DOUBLE_EQ(referenceScore(child, rest, 0, cleared), result.score);
+}
+
+TEST(GameTreeSearch, FindsLineClear)
+{
+    ThreadPool pool(2);
+    GameTreeSearch search(flatBoard, pool, 1);
+    TetrisBoard board;
+    for (int col_idx = 0; col_idx < 8; col_idx += 2)
+    {
+        board.addPiece(TetrisPiece::createQPiece(), col_idx);
+    }
+    std::vector<TetrisPiece> pieces = {TetrisPiece::createQPiece()};
+
+    SearchResult result = search.search(board, pieces);
+    ASSERT_TRUE(result.found);
+    EXPECT_EQ(result.placement.column, 8);
+}
+
+TEST(GameTreeSearch, ThreadCountDoesNotChangeResult)
+{
+    std::vector<TetrisPiece> pieces = {TetrisPiece::createZPiece(), TetrisPiece::createLPiece(), TetrisPiece::createTPiece()};
+    TetrisBoard board;
+    board.addPiece(TetrisPiece::createIPiece(), 2);
+
+    ThreadPool single(1);
+    ThreadPool many(6);
+    SearchResult single_result = GameTreeSearch(flatBoard, single).search(board, pieces);
+    SearchResult many_result = GameTreeSearch(flatBoard, many, 3).search(board, pieces);
+    EXPECT_EQ(single_result.placement, many_result.placement);
+    EXPECT_DOUBLE_EQ(single_result.score, many_result.score);
+}
+
+TEST(GameTreeSearch, EmptySequence)
+{
+    ThreadPool pool(1);
+    GameTreeSearch search(flatBoard, pool);
+    EXPECT_THROW(search.search(TetrisBoard{}, std::vector<TetrisPiece>{}), std::invalid_argument);
+}
+
+TEST(GameTreeSearch, TranspositionTableKeepsResult)
+{
+    std::vector<TetrisPiece> pieces = {TetrisPiece::createTPiece(), TetrisPiece::createLPiece(), TetrisPiece::createQPiece()};
+    TetrisBoard board;
+    board.addPiece(TetrisPiece::createZPiece(), 5);
+
+    ThreadPool pool(4);
+    TranspositionTable table(1 << 20);
+    SearchResult plain = GameTreeSearch(flatBoard, pool).search(board, pieces);
+    GameTreeSearch cached_search(flatBoard, pool, 1, &table);
+    SearchResult cached = cached_search.search(board, pieces);
+    SearchResult repeated = cached_search.search(board, pieces);
+
+    EXPECT_EQ(plain.placement, cached.placement);
+    EXPECT_DOUBLE_EQ(plain.score, cached.score);
+    EXPECT_EQ(plain.placement, repeated.placement);
+    EXPECT_DOUBLE_EQ(plain.score, repeated.score);
+}
+
+TEST(GameTreeSearch, TranspositionTableScoresAreExact)
+{
+    // Distinguishes boards by amounts far below float precision, so any rounding of cached scores changes which near tie wins
+    auto evaluate = [](const TetrisBoard &board, int lines_cleared)
+    {
+        return flatBoard(board, lines_cleared) + 1e-9 * static_cast<double>(board.hash() % 1000);
+    };
+    ThreadPool pool(4);
+    TranspositionTable table(1 << 20);
+    GameTreeSearch plain_search(evaluate, pool, 1);
+    GameTreeSearch cached_search(evaluate, pool, 1, &table);
+
+    std::vector<TetrisPiece> pieces = {TetrisPiece::createQPiece(), TetrisPiece::createQPiece(), TetrisPiece::createTPiece()};
+    TetrisBoard board;
+    board.addPiece(TetrisPiece::createZPiece(), 2);
+    SearchResult plain = plain_search.search(board, pieces);
+    for (int repeat = 0; repeat < 3; repeat++)
+    {
+        SearchResult cached = cached_search.search(board, pieces);
+        EXPECT_EQ(cached.placement, plain.placement);
+        EXPECT_EQ(cached.score, plain.score);
+    }
+}
@@ -0,0 +1,99 @@
+#include <map>
+#include <optional>
+#include <set>
+#include <vector>
+
+#include "tetris/simulator.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+    const FeatureWeights kWeights{-0.51f, -0.18f, -0.36f, 0.76f, -0.05f};
+}
+
+TEST(PieceGenerator, SameSeedSameSequence)
+{
+    PieceGenerator first(42);
+    PieceGenerator second(42);
+    PieceGenerator other(43);
+    bool differs = false;
+    for (int idx = 0; idx < 1000; idx++)
+    {
+        const TetrisPiece &piece = first.next();
+        EXPECT_EQ(piece, second.next());
+        differs |= !(piece == other.next());
+    }
+    EXPECT_TRUE(differs);
+}
+
+TEST(PieceGenerator, EveryBagHoldsEachPieceOnce)
+{
+    PieceGenerator generator(7);
+    size_t bag_size = TetrisPiece::pieceFactories.size();
+    for (int bag_idx = 0; bag_idx < 100; bag_idx++)
+    {
+        std::set<uint64_t> seen;
+        for (size_t idx = 0; idx < bag_size; idx++)
+        {
+            seen.insert(generator.next().cells);
+        }
+        EXPECT_EQ(seen.size(), bag_size);
+    }
+}
+
+TEST(Simulator, GamesAreReproducible)
+{
+    Policy policy = greedyPolicy(kWeights);
+    GameResult first = playGame(5, policy, 500);
+    GameResult second = playGame(5, policy, 500);
+
+    EXPECT_EQ(first.pieces_placed, second.pieces_placed);
+    EXPECT_EQ(first.lines_cleared, second.lines_cleared);
+    EXPECT_EQ(first.score, second.score);
+    EXPECT_EQ(first.clears_by_size, second.clears_by_size);
+}
+
+TEST(Simulator, GreedyPolicyClearsLines)
+{
+    GameResult result = playGame(1, greedyPolicy(kWeights), 1000);
+
+    EXPECT_EQ(result.pieces_placed, 1000);
+    EXPECT_FALSE(result.topped_out);
+    EXPECT_GT(result.lines_cleared, 0);
+    uint64_t line_total = 0;
+    for (size_t size = 0; size < result.clears_by_size.size(); size++)
+    {
+        line_total += size * result.clears_by_size[size];
+    }
+    EXPECT_EQ(line_total, result.lines_cleared);
+}
+
+TEST(Simulator, PolicyCanEndGame)
+{
+    Policy always_left = [](const TetrisBoard &board, const TetrisPiece &piece) -> std::optional<Placement>
+    {
+        if (board.landingRow(piece, 0) + piece.height > TetrisBoard::height)
+        {
+            return std::nullopt;
+        }
+        return Placement{piece.orientation, 0, 0};
+    };
+    GameResult result = playGame(3, always_left, 1000);
+
+    EXPECT_TRUE(result.topped_out);
+    EXPECT_LT(result.pieces_placed, 1000);
+}
+
+TEST(Simulator, SummaryTotals)
+{
+    Policy policy = greedyPolicy(kWeights);
+    SimulationSummary summary = simulate(10, 3, policy, 200);
+
+    uint64_t pieces = 0;
+    for (uint64_t seed = 10; seed < 13; seed++)
+    {
+        pieces += playGame(seed, policy, 200).pieces_placed;
+    }
+    EXPECT_EQ(summary.games, 3);
+    EXPECT_EQ(summary.pieces_placed, pieces);
+}
@@ -0,0 +1,88 @@
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tetris/board.h"
+#include "tetris/stats.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+    // Expected change of a counter: the real count when instrumentation is compiled in, and zero otherwise
+    uint64_t expected(uint64_t count)
+    {
+        return kStatsEnabled ? count : 0;
+    }
+}
+
+TEST(Stats, CountsEngineOperations)
+{
+    StatsSnapshot before = collectStats();
+
+    TetrisBoard board;
+    for (int col_idx = 0; col_idx < TetrisBoard::width; col_idx += 2)
+    {
+        board.addPiece(TetrisPiece::createQPiece(), col_idx);
+    }
+    board.collides(TetrisPiece::createTPiece(), 0, 0);
+    TetrisPiece piece = TetrisPiece::createLPiece();
+    piece.rotateClockwise();
+    piece.flipHorizontal();
+    TetrisPiece custom(0x3, 2, 1);
+
+    StatsSnapshot activity = collectStats() - before;
+    EXPECT_EQ(activity.counter(StatCounter::AddPiece), expected(5));
+    EXPECT_EQ(activity.counter(StatCounter::LineClears), expected(1));
+    EXPECT_EQ(activity.counter(StatCounter::LinesCleared), expected(2));
+    EXPECT_EQ(activity.counter(StatCounter::CollisionChecks), expected(1));
+    EXPECT_EQ(activity.counter(StatCounter::Rotations), expected(2));
+    EXPECT_EQ(activity.counter(StatCounter::PieceConstructions), expected(1));
+    EXPECT_EQ(activity.timer_calls[static_cast<size_t>(StatTimer::AddPiece)], expected(5));
+    EXPECT_EQ(activity.timer_calls[static_cast<size_t>(StatTimer::LineClear)], expected(1));
+}
+
+TEST(Stats, AggregatesAcrossThreads)
+{
+    StatsSnapshot before = collectStats();
+    std::vector<std::thread> threads;
+    for (int thread_idx = 0; thread_idx < 4; thread_idx++)
+    {
+        threads.emplace_back([]
+                             {
+            TetrisBoard board;
+            for (int drop = 0; drop < 100; drop++)
+            {
+                board.collides(TetrisPiece::createIPiece(), 0, 0);
+            } });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    // Counts of threads that have exited are kept
+    StatsSnapshot activity = collectStats() - before;
+    EXPECT_EQ(activity.counter(StatCounter::CollisionChecks), expected(400));
+}
+
+TEST(Stats, Dumps)
+{
+    StatsSnapshot snapshot;
+    snapshot.counters[static_cast<size_t>(StatCounter::LinesCleared)] = 42;
+    snapshot.timer_calls[static_cast<size_t>(StatTimer::AddPiece)] = 3;
+    snapshot.timer_nanoseconds[static_cast<size_t>(StatTimer::AddPiece)] = 1500000000;
+
+    std::ostringstream json;
+    writeStatsJson(json, snapshot);
+    EXPECT_NE(json.str().find("\"lines_cleared\": 42"), std::string::npos);
+    EXPECT_NE(json.str().find("\"add_piece\": {\"calls\": 3, \"nanoseconds\": 1500000000}"), std::string::npos);
+
+    std::ostringstream prometheus;
+    writeStatsPrometheus(prometheus, snapshot);
+    EXPECT_NE(prometheus.str().find("# TYPE tetris_lines_cleared_total counter\ntetris_lines_cleared_total 42\n"), std::string::npos);
+    EXPECT_NE(prometheus.str().find("tetris_add_piece_calls_total 3\n"), std::string::npos);
+    EXPECT_NE(prometheus.str().find("tetris_add_piece_seconds_total 1.5\n"), std::string::npos);
+    EXPECT_STREQ(statName(StatCounter::CollisionChecks), "collision_checks");
+    EXPECT_STREQ(statName(StatTimer::LineClear), "line_clear");
+}
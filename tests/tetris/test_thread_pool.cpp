@@ -0,0 +1,86 @@
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "tetris/thread_pool.h"
+#include <gtest/gtest.h>
+
+TEST(ThreadPool, RunsEveryTask)
+{
+    ThreadPool pool(4);
+    std::vector<int> results(1000, 0);
+    TaskGroup group;
+    for (size_t idx = 0; idx < results.size(); idx++)
+    {
+        pool.run(group, [&results, idx]
+                 { results[idx] = static_cast<int>(idx) * 2; });
+    }
+    pool.wait(group);
+
+    for (size_t idx = 0; idx < results.size(); idx++)
+    {
+        EXPECT_EQ(results[idx], static_cast<int>(idx) * 2);
+    }
+}
+
+TEST(ThreadPool, NestedGroups)
+{
+    ThreadPool pool(3);
+    std::atomic<int> leaves{0};
+    TaskGroup outer;
+    for (int outer_idx = 0; outer_idx < 16; outer_idx++)
+    {
+        pool.run(outer, [&]
+                 {
+            TaskGroup inner;
+            for (int inner_idx = 0; inner_idx < 16; inner_idx++)
+            {
+                pool.run(inner, [&]
+                         { leaves.fetch_add(1); });
+            }
+            pool.wait(inner); });
+    }
+    pool.wait(outer);
+
+    EXPECT_EQ(leaves.load(), 256);
+}
+
+TEST(ThreadPool, WaitRethrowsTaskExceptions)
+{
+    ThreadPool pool(2);
+    std::atomic<int> completed{0};
+    TaskGroup group;
+    for (int idx = 0; idx < 200; idx++)
+    {
+        // Throwing tasks run on workers and on the waiting thread alike
+        pool.run(group, [&completed, idx]
+                 {
+            if (idx % 50 == 7)
+            {
+                throw std::runtime_error("task failed");
+            }
+            completed.fetch_add(1); });
+    }
+    EXPECT_THROW(pool.wait(group), std::runtime_error);
+    // Every other task still ran before wait returned
+    EXPECT_EQ(completed.load(), 196);
+
+    // Exceptions cross nested groups, and a group is clean again once waited on
+    pool.run(group, [&pool]
+             {
+        TaskGroup inner;
+        pool.run(inner, []
+                 { throw std::logic_error("inner task failed"); });
+        pool.wait(inner); });
+    EXPECT_THROW(pool.wait(group), std::logic_error);
+    pool.run(group, [&completed]
+             { completed.fetch_add(1); });
+    EXPECT_NO_THROW(pool.wait(group));
+    EXPECT_EQ(completed.load(), 197);
+}
+
+TEST(ThreadPool, DefaultThreadCount)
+{
+    ThreadPool pool;
+    EXPECT_GE(pool.threadCount(), 1);
+}
@@ -0,0 +1,110 @@
+#include <stdexcept>
+
+#include "tetris/board.h"
+#include "tetris/transposition_table.h"
+#include <gtest/gtest.h>
+
+TEST(ZobristHash, EqualBoardsHashEqual)
+{
+    // Reach the same cells through different drop orders, including a line clear
+    TetrisBoard first;
+    first.addPiece(TetrisPiece::createQPiece(), 0);
+    first.addPiece(TetrisPiece::createIPiece(), 2);
+
+    TetrisBoard second;
+    second.addPiece(TetrisPiece::createIPiece(), 2);
+    second.addPiece(TetrisPiece::createQPiece(), 0);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(first.hash(), second.hash());
+
+    // Clearing the bottom row of a Q piece leaves its top row, which then shifts down
+    TetrisBoard cleared;
+    cleared.addPiece(TetrisPiece::createQPiece(), 0);
+    cleared.addPiece(TetrisPiece::createIPiece(), 2);
+    EXPECT_EQ(cleared.addPiece(TetrisPiece::createIPiece(), 6), 1);
+    TetrisBoard direct;
+    direct.addPiece(TetrisPiece{{{true}, {true}}}, 0);
+    EXPECT_EQ(cleared, direct);
+    EXPECT_EQ(cleared.hash(), direct.hash());
+}
+
+TEST(ZobristHash, EmptyBoardAndDifferentBoards)
+{
+    TetrisBoard empty;
+    TetrisBoard one;
+    one.addPiece(TetrisPiece{{{true}}}, 0);
+    TetrisBoard other;
+    other.addPiece(TetrisPiece{{{true}}}, 1);
+
+    EXPECT_EQ(empty.hash(), 0);
+    EXPECT_NE(one.hash(), other.hash());
+    EXPECT_NE(one.hash(), empty.hash());
+}
+
+TEST(ZobristHash, PieceKeyIgnoresOrientation)
+{
+    TetrisPiece piece = TetrisPiece::createLPiece();
+    uint64_t key = zobristPiece(piece);
+    piece.rotateClockwise();
+    piece.flipHorizontal();
+
+    EXPECT_EQ(zobristPiece(piece), key);
+    EXPECT_NE(zobristPiece(TetrisPiece::createTPiece()), key);
+}
+
+TEST(TranspositionTable, StoreAndProbe)
+{
+    TranspositionTable table(1024);
+    TranspositionEntry entry;
+    EXPECT_EQ(table.capacity(), 32);
+    EXPECT_FALSE(table.probe(12345, entry));
+
+    table.store(12345, TranspositionEntry{-2.5f, 3, Placement{5, 7, 12}});
+    ASSERT_TRUE(table.probe(12345, entry));
+    EXPECT_EQ(entry.score, -2.5f);
+    EXPECT_EQ(entry.depth, 3);
+    EXPECT_EQ(entry.best, (Placement{5, 7, 12}));
+
+    // Scores come back exactly, not rounded through float
+    table.store(54321, TranspositionEntry{0.1, 2, Placement{}});
+    ASSERT_TRUE(table.probe(54321, entry));
+    EXPECT_EQ(entry.score, 0.1);
+
+    // Same slot, different key
+    EXPECT_FALSE(table.probe(12345 + table.capacity(), entry));
+
+    table.clear();
+    EXPECT_FALSE(table.probe(12345, entry));
+}
+
+TEST(TranspositionTable, DepthPreferredReplacement)
+{
+    TranspositionTable table(1024, ReplacementPolicy::DepthPreferred);
+    TranspositionEntry entry;
+    table.store(7, TranspositionEntry{1.0f, 4, Placement{}});
+    table.store(7 + table.capacity(), TranspositionEntry{2.0f, 2, Placement{}});
+    ASSERT_TRUE(table.probe(7, entry));
+    EXPECT_EQ(entry.score, 1.0f);
+
+    // Shallower entries replace deeper ones once the generation moves on
+    table.newGeneration();
+    table.store(7 + table.capacity(), TranspositionEntry{2.0f, 2, Placement{}});
+    EXPECT_FALSE(table.probe(7, entry));
+    EXPECT_TRUE(table.probe(7 + table.capacity(), entry));
+}
+
+TEST(TranspositionTable, AlwaysReplace)
+{
+    TranspositionTable table(1024, ReplacementPolicy::AlwaysReplace);
+    TranspositionEntry entry;
+    table.store(7, TranspositionEntry{1.0f, 4, Placement{}});
+    table.store(7 + table.capacity(), TranspositionEntry{2.0f, 2, Placement{}});
+
+    EXPECT_FALSE(table.probe(7, entry));
+    EXPECT_TRUE(table.probe(7 + table.capacity(), entry));
+}
+
+TEST(TranspositionTable, TooSmall)
+{
+    EXPECT_THROW(TranspositionTable table(8), std::invalid_argument);
+}
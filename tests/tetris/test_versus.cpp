@@ -0,0 +1,79 @@
+#include <optional>
+#include <vector>
+
+#include "tetris/versus.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+    const FeatureWeights kWeights{-0.51f, -0.18f, -0.36f, 0.76f, -0.05f};
+}
+
+TEST(AttackCounter, CombosAndBackToBack)
+{
+    AttackCounter counter;
+    EXPECT_EQ(counter.recordClear(0), 0);
+    EXPECT_EQ(counter.combo(), -1);
+
+    // A single sends nothing by itself, but each clear extends the combo
+    EXPECT_EQ(counter.recordClear(1), 0);
+    EXPECT_EQ(counter.recordClear(2), 1 + kComboAttack[1]);
+    EXPECT_EQ(counter.recordClear(4), 4 + kComboAttack[2]);
+    EXPECT_TRUE(counter.backToBack());
+    EXPECT_EQ(counter.recordClear(4), 4 + kComboAttack[3] + kBackToBackAttack);
+    EXPECT_EQ(counter.combo(), 3);
+
+    // An easier clear breaks back-to-back, and a piece clearing nothing breaks the combo
+    EXPECT_EQ(counter.recordClear(3), 2 + kComboAttack[4]);
+    EXPECT_FALSE(counter.backToBack());
+    EXPECT_EQ(counter.recordClear(0), 0);
+    EXPECT_EQ(counter.recordClear(4), 4);
+    EXPECT_EQ(counter.longestCombo(), 4);
+    EXPECT_EQ(counter.backToBackCount(), 1u);
+    EXPECT_EQ(counter.totalAttack(), 1u + 5 + 6 + 3 + 4);
+
+    // Very long combos keep sending the last entry of the table
+    AttackCounter long_combo;
+    int attack = 0;
+    for (size_t piece = 0; piece < kComboAttack.size() + 5; piece++)
+    {
+        attack = long_combo.recordClear(1);
+    }
+    EXPECT_EQ(attack, kComboAttack.back());
+}
+
+TEST(Versus, GarbageFlowsBetweenPlayers)
+{
+    Policy greedy = greedyPolicy(kWeights);
+    VersusResult result = playVersusGame(11, greedy, greedy, 500);
+    VersusResult again = playVersusGame(11, greedy, greedy, 500);
+    for (size_t player_idx = 0; player_idx < 2; player_idx++)
+    {
+        const VersusPlayerResult &player = result.players[player_idx];
+        const VersusPlayerResult &opponent = result.players[1 - player_idx];
+        EXPECT_EQ(player.pieces_placed, again.players[player_idx].pieces_placed);
+        EXPECT_EQ(player.garbage_sent, again.players[player_idx].garbage_sent);
+        EXPECT_LE(player.garbage_received, opponent.garbage_sent);
+        EXPECT_GT(player.pieces_placed, 0u);
+    }
+    EXPECT_GT(result.players[0].garbage_sent + result.players[1].garbage_sent, 0u);
+    if (result.winner >= 0)
+    {
+        EXPECT_TRUE(result.players[1 - result.winner].topped_out);
+        EXPECT_FALSE(result.players[result.winner].topped_out);
+    }
+}
+
+TEST(Versus, PolicyWhichGivesUpLoses)
+{
+    Policy greedy = greedyPolicy(kWeights);
+    Policy resign = [](const TetrisBoard &, const TetrisPiece &) -> std::optional<Placement>
+    {
+        return std::nullopt;
+    };
+    VersusResult result = playVersusGame(3, greedy, resign, 100);
+    EXPECT_EQ(result.winner, 0);
+    EXPECT_TRUE(result.players[1].topped_out);
+    EXPECT_EQ(result.players[0].pieces_placed, 1u);
+    EXPECT_EQ(result.players[1].pieces_placed, 0u);
+}